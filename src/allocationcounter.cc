@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "allocationcounter.hh"
+
+#ifdef CODE_COMPREHENSION_ALLOCATION_ACCOUNTING
+#    include <cstddef>
+#    include <cstdlib>
+#    include <new>
+#endif
+
+namespace CodeComprehension::Allocations {
+
+namespace {
+
+// Constant-initialized, so using it from operator new doesn't allocate.
+thread_local AllocationCounts s_counts_of_current_thread;
+
+}
+
+AllocationCounts of_current_thread()
+{
+    return s_counts_of_current_thread;
+}
+
+}
+
+#ifdef CODE_COMPREHENSION_ALLOCATION_ACCOUNTING
+
+namespace {
+
+void* allocate(size_t size, size_t alignment)
+{
+    if (size == 0)
+        size = 1;
+    auto& counts = CodeComprehension::Allocations::s_counts_of_current_thread;
+    ++counts.count;
+    counts.bytes += size;
+
+    for (;;) {
+        // aligned_alloc() wants the size to be a multiple of the alignment.
+        void* pointer = alignment <= alignof(std::max_align_t) ? malloc(size) : aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if (pointer)
+            return pointer;
+        auto handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+}
+
+// The other forms of operator new and delete are implemented on top of these by the standard library.
+void* operator new(size_t size)
+{
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept
+{
+    free(pointer);
+}
+
+#endif
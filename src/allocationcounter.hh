@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <cstdint>
+
+// Counts the heap allocations of every thread by replacing the global operator new.
+//
+// Only compiled in with CODE_COMPREHENSION_ALLOCATION_ACCOUNTING (see the CMake option of the same name), as the
+// replacement applies to the whole program that links the engine. Without it, all counts stay at zero.
+// The counts include the allocations of the parser and of the standard library, not only those of the engine.
+
+namespace CodeComprehension {
+
+struct AllocationCounts {
+    uint64_t count { 0 };
+    uint64_t bytes { 0 };
+
+    AllocationCounts operator-(AllocationCounts const& other) const { return { count - other.count, bytes - other.bytes }; }
+    AllocationCounts& operator+=(AllocationCounts const& other)
+    {
+        count += other.count;
+        bytes += other.bytes;
+        return *this;
+    }
+};
+
+namespace Allocations {
+
+#ifdef CODE_COMPREHENSION_ALLOCATION_ACCOUNTING
+constexpr bool is_compiled_in = true;
+#else
+constexpr bool is_compiled_in = false;
+#endif
+
+// Allocations made by the calling thread since it started. Deallocations aren't subtracted.
+AllocationCounts of_current_thread();
+
+}
+
+}
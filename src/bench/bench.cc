@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+// Measures the latency of every entry point of the C++ engine on a set of corpora.
+//
+// Usage: bench [--warmup N] [--repetitions N] [--json FILE] [--trace FILE] [--perf-counters] [--file FILE]... [--corpus DIRECTORY]... [--generate SOURCES]...
+//
+// --trace writes a Chrome trace of the whole run, which needs a build with CODE_COMPREHENSION_TRACING.
+// --perf-counters also counts cycles, instructions, cache misses and branch misses of every benchmark (Linux only).
+// With CODE_COMPREHENSION_TRACING, the events are attributed to the phases of the engine as well.
+// A build with CODE_COMPREHENSION_ALLOCATION_ACCOUNTING reports the heap allocations of every benchmark,
+// and of every phase of the engine if tracing is compiled in too.
+// --generate runs on a synthetic project with the given number of source files, see CorpusOptions.
+// Without a --file, --corpus or --generate, test/AST.cpp is used. Every .cc/.cpp file of a corpus is a "main" file
+// that queries are made in, the other files are only reachable through #includes.
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench/harness.hh"
+#include "corpus/corpusgenerator.hh"
+#include "cpp/cppcomprehensionengine.hh"
+#include "filedb.hh"
+#include "trace.hh"
+
+using namespace CodeComprehension;
+
+namespace {
+
+class MemoryFileDB final : public FileDB {
+public:
+    void add(std::string filename, std::string content) { m_files.insert_or_assign(std::move(filename), std::move(content)); }
+
+    virtual std::optional<std::string> get_or_read_from_filesystem(std::string_view filename) const override
+    {
+        auto it = m_files.find(std::string { filename });
+        if (it == m_files.end())
+            return std::nullopt;
+        return it->second;
+    }
+
+private:
+    std::unordered_map<std::string, std::string> m_files;
+};
+
+struct Corpus {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> files;
+    std::vector<std::string> main_files;
+};
+
+std::optional<std::string> read_all(std::filesystem::path const& path)
+{
+    std::ifstream file(path);
+    if (!file)
+        return {};
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+bool is_main_file(std::filesystem::path const& path)
+{
+    auto extension = path.extension();
+    return extension == ".cc" || extension == ".cpp" || extension == ".cxx";
+}
+
+std::optional<Corpus> load_file(std::filesystem::path const& path)
+{
+    auto content = read_all(path);
+    if (!content.has_value())
+        return {};
+    auto name = path.filename().string();
+    return Corpus { name, { { name, std::move(content.value()) } }, { name } };
+}
+
+std::optional<Corpus> load_directory(std::filesystem::path const& directory)
+{
+    Corpus corpus;
+    corpus.name = directory.filename().empty() ? directory.parent_path().filename().string() : directory.filename().string();
+    std::error_code error;
+    for (auto const& entry : std::filesystem::recursive_directory_iterator(directory, error)) {
+        if (!entry.is_regular_file())
+            continue;
+        auto content = read_all(entry.path());
+        if (!content.has_value())
+            continue;
+        // Paths are relative to the corpus, which is how #include "..." paths are resolved without a project root.
+        auto name = std::filesystem::relative(entry.path(), directory).generic_string();
+        if (is_main_file(entry.path()))
+            corpus.main_files.push_back(name);
+        corpus.files.emplace_back(std::move(name), std::move(content.value()));
+    }
+    if (error || corpus.main_files.empty())
+        return {};
+    std::sort(corpus.main_files.begin(), corpus.main_files.end());
+    return corpus;
+}
+
+Corpus generate(size_t source_count)
+{
+    CorpusOptions options;
+    options.source_count = source_count;
+    // Keep the number of headers proportional to the number of sources, so that the whole project grows.
+    options.headers_per_level = std::max<size_t>(options.headers_per_level, source_count);
+
+    Corpus corpus;
+    corpus.name = "generated-" + std::to_string(source_count);
+    for (auto& file : generate_corpus(options)) {
+        if (is_main_file(file.path))
+            corpus.main_files.push_back(file.path);
+        corpus.files.emplace_back(std::move(file.path), std::move(file.content));
+    }
+    return corpus;
+}
+
+struct QueryPosition {
+    std::string file;
+    GUI::TextPosition position;
+};
+
+// Positions of identifiers (for declaration lookups and completion) and of call arguments (for parameter hints), evenly spread over the main files.
+struct QueryPositions {
+    std::vector<QueryPosition> identifier_starts;
+    std::vector<QueryPosition> identifier_ends;
+    std::vector<QueryPosition> call_arguments;
+};
+
+constexpr size_t max_positions_per_file = 64;
+
+template<typename T>
+void append_evenly_spread(std::vector<T>& destination, std::vector<T> const& source)
+{
+    size_t step = std::max<size_t>(1, source.size() / max_positions_per_file);
+    for (size_t i = 0; i < source.size(); i += step)
+        destination.push_back(source[i]);
+}
+
+QueryPositions find_query_positions(Cpp::CppComprehensionEngine& engine, Corpus const& corpus, MemoryFileDB const& filedb)
+{
+    QueryPositions positions;
+    for (auto const& file : corpus.main_files) {
+        std::vector<QueryPosition> starts;
+        std::vector<QueryPosition> ends;
+        for (auto const& token : engine.get_tokens_info(file)) {
+            using SemanticType = TokenInfo::SemanticType;
+            switch (token.type) {
+            case SemanticType::Identifier:
+            case SemanticType::Function:
+            case SemanticType::Variable:
+            case SemanticType::CustomType:
+            case SemanticType::Member:
+            case SemanticType::Parameter:
+                if (token.start_line != token.end_line)
+                    break;
+                starts.push_back({ file, { token.start_line, token.start_column } });
+                ends.push_back({ file, { token.end_line, token.end_column + 1 } });
+                break;
+            default:
+                break;
+            }
+        }
+        append_evenly_spread(positions.identifier_starts, starts);
+        append_evenly_spread(positions.identifier_ends, ends);
+
+        std::vector<QueryPosition> arguments;
+        auto text = filedb.get_or_read_from_filesystem(file).value_or("");
+        size_t line = 0;
+        size_t column = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '\n') {
+                ++line;
+                column = 0;
+                continue;
+            }
+            if (text[i] == '(' && i > 0 && (std::isalnum(static_cast<unsigned char>(text[i - 1])) || text[i - 1] == '_'))
+                arguments.push_back({ file, { line, column + 1 } });
+            ++column;
+        }
+        append_evenly_spread(positions.call_arguments, arguments);
+    }
+    return positions;
+}
+
+void run_corpus(Corpus const& corpus, Bench::Options const& options, std::vector<Bench::Result>& results)
+{
+    MemoryFileDB filedb;
+    for (auto const& [name, content] : corpus.files)
+        filedb.add(name, content);
+
+    // Cold: every iteration starts with an empty engine, so the main file and all of its headers are parsed.
+    std::unique_ptr<Cpp::CppComprehensionEngine> cold_engine;
+    results.push_back(Bench::measure(
+        "file_opened (cold)", corpus.name, options,
+        [&](size_t) { cold_engine = std::make_unique<Cpp::CppComprehensionEngine>(filedb); },
+        [&](size_t iteration) { cold_engine->file_opened(corpus.main_files[iteration % corpus.main_files.size()]); }));
+    cold_engine.reset();
+
+    Cpp::CppComprehensionEngine engine(filedb);
+    for (auto const& file : corpus.main_files)
+        engine.file_opened(file);
+    auto positions = find_query_positions(engine, corpus, filedb);
+
+    auto measure_at = [&](char const* benchmark, std::vector<QueryPosition> const& query_positions, auto query) {
+        if (query_positions.empty())
+            return;
+        results.push_back(Bench::measure(benchmark, corpus.name, options, [&](size_t iteration) {
+            auto const& query_position = query_positions[iteration % query_positions.size()];
+            query(query_position.file, query_position.position);
+        }));
+    };
+
+    measure_at("get_suggestions", positions.identifier_ends, [&](auto const& file, auto const& position) { engine.get_suggestions(file, position); });
+    measure_at("find_declaration_of", positions.identifier_starts, [&](auto const& file, auto const& position) { engine.find_declaration_of(file, position); });
+    measure_at("get_function_params_hint", positions.call_arguments, [&](auto const& file, auto const& position) { engine.get_function_params_hint(file, position); });
+
+    results.push_back(Bench::measure("get_tokens_info", corpus.name, options, [&](size_t iteration) {
+        engine.get_tokens_info(corpus.main_files[iteration % corpus.main_files.size()]);
+    }));
+
+    // Re-parses the main file, its headers are already parsed.
+    results.push_back(Bench::measure("on_edit", corpus.name, options, [&](size_t iteration) {
+        engine.on_edit(corpus.main_files[iteration % corpus.main_files.size()]);
+    }));
+}
+
+std::optional<std::string> default_corpus_path(char const* program)
+{
+    // Written by CMake next to the executables, like for the test target.
+    // Look in the working directory first, and then next to the executable so that it can be run from anywhere.
+    for (auto const& directory : { std::filesystem::path {}, std::filesystem::path { program }.parent_path() }) {
+        std::ifstream file(directory / "project_source_dir.txt");
+        std::string source_dir;
+        if (file && std::getline(file, source_dir))
+            return source_dir + "/test/AST.cpp";
+    }
+    return {};
+}
+
+int usage(char const* program)
+{
+    fprintf(stderr, "Usage: %s [--warmup N] [--repetitions N] [--json FILE] [--trace FILE] [--perf-counters] [--file FILE]... [--corpus DIRECTORY]... [--generate SOURCES]...\n", program);
+    return 1;
+}
+
+void print_hardware_event_totals(std::vector<Trace::HardwareEventTotals> const& totals)
+{
+    printf("\n%-40s %8s %14s %14s %6s %12s %12s\n", "phase (inclusive)", "calls", "cycles", "instructions", "IPC", "LLC misses", "br misses");
+    for (auto const& [name, calls, counts] : totals) {
+        double ipc = counts.cycles == 0 ? 0 : static_cast<double>(counts.instructions) / static_cast<double>(counts.cycles);
+        printf("%-40s %8lu %14lu %14lu %6.2f %12lu %12lu\n", name, static_cast<unsigned long>(calls),
+            static_cast<unsigned long>(counts.cycles), static_cast<unsigned long>(counts.instructions), ipc,
+            static_cast<unsigned long>(counts.cache_misses), static_cast<unsigned long>(counts.branch_misses));
+    }
+}
+
+void print_allocation_totals(std::vector<Trace::AllocationTotals> const& totals)
+{
+    printf("\n%-40s %8s %14s %14s %12s\n", "phase (inclusive)", "calls", "allocations", "bytes", "bytes/call");
+    for (auto const& [name, calls, counts] : totals) {
+        printf("%-40s %8lu %14lu %14lu %12lu\n", name, static_cast<unsigned long>(calls), static_cast<unsigned long>(counts.count),
+            static_cast<unsigned long>(counts.bytes), static_cast<unsigned long>(calls == 0 ? 0 : counts.bytes / calls));
+    }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Bench::Options options;
+    std::optional<std::string> json_path;
+    std::optional<std::string> trace_path;
+    bool should_count_hardware_events = false;
+    std::vector<Corpus> corpora;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view argument = argv[i];
+        if (argument == "--perf-counters") {
+            should_count_hardware_events = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return usage(argv[0]);
+        char const* value = argv[++i];
+        if (argument == "--warmup") {
+            options.warmup = std::stoul(value);
+        } else if (argument == "--repetitions") {
+            options.repetitions = std::stoul(value);
+        } else if (argument == "--json") {
+            json_path = value;
+        } else if (argument == "--trace") {
+            trace_path = value;
+        } else if (argument == "--generate") {
+            corpora.push_back(generate(std::stoul(value)));
+        } else if (argument == "--file" || argument == "--corpus") {
+            auto corpus = argument == "--file" ? load_file(value) : load_directory(value);
+            if (!corpus.has_value()) {
+                fprintf(stderr, "Unable to load %s\n", value);
+                return 1;
+            }
+            corpora.push_back(std::move(corpus.value()));
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    if (corpora.empty()) {
+        auto path = default_corpus_path(argv[0]);
+        auto corpus = path.has_value() ? load_file(path.value()) : std::nullopt;
+        if (!corpus.has_value()) {
+            fprintf(stderr, "Unable to find test/AST.cpp, pass a --file, --corpus or --generate\n");
+            return 1;
+        }
+        corpora.push_back(std::move(corpus.value()));
+    }
+
+    if (trace_path.has_value()) {
+        if (!Trace::is_compiled_in)
+            fprintf(stderr, "Tracing is not compiled in, the trace will be empty\n");
+        Trace::start_recording();
+    }
+
+    std::unique_ptr<PerfCounters> counters;
+    if (should_count_hardware_events) {
+        std::string error;
+        counters = PerfCounters::create(&error);
+        if (!counters) {
+            fprintf(stderr, "Hardware counters are unavailable (%s), only measuring latencies\n", error.c_str());
+        } else {
+            for (auto const& event : counters->unavailable_events())
+                fprintf(stderr, "Hardware event '%s' is unavailable and reads as 0\n", event.c_str());
+            options.counters = counters.get();
+            if (Trace::is_compiled_in)
+                Trace::start_counting_hardware_events();
+        }
+    }
+
+    bool should_count_allocations = Allocations::is_compiled_in && Trace::is_compiled_in;
+    if (should_count_allocations)
+        Trace::start_counting_allocations();
+
+    std::vector<Bench::Result> results;
+    for (auto const& corpus : corpora)
+        run_corpus(corpus, options, results);
+
+    if (trace_path.has_value()) {
+        Trace::stop_recording();
+        if (!Trace::write_chrome_trace(trace_path.value())) {
+            fprintf(stderr, "Unable to write %s\n", trace_path->c_str());
+            return 1;
+        }
+    }
+
+    Bench::print_results(results);
+    if (options.counters && Trace::is_compiled_in) {
+        Trace::stop_counting_hardware_events();
+        print_hardware_event_totals(Trace::hardware_event_totals());
+    }
+    if (should_count_allocations) {
+        Trace::stop_counting_allocations();
+        print_allocation_totals(Trace::allocation_totals());
+    }
+    if (json_path.has_value()) {
+        FILE* stream = fopen(json_path->c_str(), "w");
+        if (!stream) {
+            fprintf(stderr, "Unable to write %s\n", json_path->c_str());
+            return 1;
+        }
+        Bench::write_json(results, stream);
+        fclose(stream);
+    }
+    return 0;
+}
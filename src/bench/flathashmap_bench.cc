@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+// Compares std::unordered_map and FlatHashMap on the access patterns of the engine's symbol tables:
+// iterating the tables of every document in a large include closure (for_each_available_symbol),
+// and looking a qualified name up in each of them (find_declaration_of).
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cpp/symbolname.hh"
+#include "flathashmap.hh"
+
+using namespace CodeComprehension;
+using CodeComprehension::Cpp::KeySymbolHash;
+using CodeComprehension::Cpp::SymbolName;
+
+namespace {
+
+// Roughly the size of a Symbol: a name, a scope, a pointer to the declaration and a flag.
+struct Symbol {
+    SymbolName name;
+    void const* declaration { nullptr };
+    bool is_local { false };
+};
+
+template<typename Callback>
+double measure_milliseconds(Callback callback)
+{
+    auto start = std::chrono::steady_clock::now();
+    callback();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template<typename Map>
+void run(char const* map_name, std::vector<std::string> const& names, std::vector<std::string_view> const& scopes, size_t document_count, size_t symbols_per_document, size_t lookup_count)
+{
+    std::vector<Map> documents(document_count);
+    std::mt19937 random(1337);
+
+    auto build_ms = measure_milliseconds([&] {
+        for (auto& document : documents) {
+            for (size_t i = 0; i < symbols_per_document; ++i) {
+                SymbolName name { names[random() % names.size()], { &scopes[random() % scopes.size()], 1 } };
+                document.emplace(name, Symbol { name, &document, false });
+            }
+        }
+    });
+
+    size_t visited = 0;
+    auto iterate_ms = measure_milliseconds([&] {
+        for (size_t repetition = 0; repetition < 10; ++repetition) {
+            for (auto const& document : documents) {
+                for (auto const& item : document)
+                    visited += item.second.is_local ? 2 : 1;
+            }
+        }
+    });
+
+    size_t found = 0;
+    auto lookup_ms = measure_milliseconds([&] {
+        for (size_t i = 0; i < lookup_count; ++i) {
+            SymbolName key { names[random() % names.size()], { &scopes[random() % scopes.size()], 1 } };
+            for (auto const& document : documents) {
+                if (document.find(key) != document.end())
+                    ++found;
+            }
+        }
+    });
+
+    printf("%-20s build: %8.2f ms  iterate (x10): %8.2f ms  lookup: %8.2f ms  (visited %zu, found %zu)\n", map_name, build_ms, iterate_ms, lookup_ms, visited, found);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t document_count = argc > 1 ? std::stoul(argv[1]) : 500;
+    size_t symbols_per_document = argc > 2 ? std::stoul(argv[2]) : 400;
+    size_t lookup_count = argc > 3 ? std::stoul(argv[3]) : 2000;
+
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 20000; ++i)
+        names.push_back("symbol_name_" + std::to_string(i));
+    std::vector<std::string> scope_names;
+    for (size_t i = 0; i < 50; ++i)
+        scope_names.push_back("Namespace" + std::to_string(i));
+    // Every key's scope is a single one of these.
+    std::vector<std::string_view> scopes(scope_names.begin(), scope_names.end());
+
+    printf("%zu documents, %zu symbols per document, %zu lookups\n", document_count, symbols_per_document, lookup_count);
+    run<std::unordered_map<SymbolName, Symbol, KeySymbolHash>>("std::unordered_map", names, scopes, document_count, symbols_per_document, lookup_count);
+    run<FlatHashMap<SymbolName, Symbol, KeySymbolHash>>("FlatHashMap", names, scopes, document_count, symbols_per_document, lookup_count);
+    return 0;
+}
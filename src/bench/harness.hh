@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "allocationcounter.hh"
+#include "perfcounters.hh"
+
+namespace CodeComprehension::Bench {
+
+struct Options {
+    // Iterations that run before the measured ones, so that caches and lazily built tables are warm.
+    size_t warmup { 3 };
+    size_t repetitions { 30 };
+    // If set, the hardware events of every measured iteration are counted too.
+    PerfCounters const* counters { nullptr };
+};
+
+// Latencies are in microseconds.
+struct Result {
+    std::string benchmark;
+    std::string corpus;
+    size_t repetitions { 0 };
+    double min { 0 };
+    double mean { 0 };
+    double p50 { 0 };
+    double p90 { 0 };
+    double p99 { 0 };
+    double max { 0 };
+    // Per iteration, on average.
+    std::optional<HardwareEventCounts> hardware_events;
+    // Per iteration, on average. Only set if Allocations::is_compiled_in.
+    std::optional<AllocationCounts> allocations;
+};
+
+// Nearest-rank percentile of sorted samples.
+inline double percentile(std::vector<double> const& sorted_samples, double fraction)
+{
+    if (sorted_samples.empty())
+        return 0;
+    auto rank = static_cast<size_t>(fraction * static_cast<double>(sorted_samples.size()) + 0.5);
+    return sorted_samples[std::clamp<size_t>(rank, 1, sorted_samples.size()) - 1];
+}
+
+inline Result summarize(std::string benchmark, std::string corpus, std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    Result result;
+    result.benchmark = std::move(benchmark);
+    result.corpus = std::move(corpus);
+    result.repetitions = samples.size();
+    if (samples.empty())
+        return result;
+
+    double sum = 0;
+    for (auto sample : samples)
+        sum += sample;
+    result.min = samples.front();
+    result.mean = sum / static_cast<double>(samples.size());
+    result.p50 = percentile(samples, 0.50);
+    result.p90 = percentile(samples, 0.90);
+    result.p99 = percentile(samples, 0.99);
+    result.max = samples.back();
+    return result;
+}
+
+// Runs 'setup' and then 'callback' for every iteration, only the time spent in 'callback' is measured.
+// Both get the index of the iteration (counting the warmup), so that a benchmark can cycle through its inputs.
+template<typename Setup, typename Callback>
+Result measure(std::string benchmark, std::string corpus, Options const& options, Setup setup, Callback callback)
+{
+    std::vector<double> samples;
+    samples.reserve(options.repetitions);
+    HardwareEventCounts hardware_events;
+    AllocationCounts allocations;
+    for (size_t iteration = 0; iteration < options.warmup + options.repetitions; ++iteration) {
+        setup(iteration);
+        HardwareEventCounts start_counts;
+        if (options.counters)
+            start_counts = options.counters->read();
+        auto start_allocations = Allocations::of_current_thread();
+        auto start = std::chrono::steady_clock::now();
+        callback(iteration);
+        auto end = std::chrono::steady_clock::now();
+        if (iteration < options.warmup)
+            continue;
+        samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        if (options.counters)
+            hardware_events += options.counters->read() - start_counts;
+        allocations += Allocations::of_current_thread() - start_allocations;
+    }
+
+    auto result = summarize(std::move(benchmark), std::move(corpus), std::move(samples));
+    if (options.counters && result.repetitions > 0) {
+        auto repetitions = result.repetitions;
+        result.hardware_events = HardwareEventCounts { hardware_events.cycles / repetitions, hardware_events.instructions / repetitions, hardware_events.cache_misses / repetitions, hardware_events.branch_misses / repetitions };
+    }
+    if (Allocations::is_compiled_in && result.repetitions > 0)
+        result.allocations = AllocationCounts { allocations.count / result.repetitions, allocations.bytes / result.repetitions };
+    return result;
+}
+
+template<typename Callback>
+Result measure(std::string benchmark, std::string corpus, Options const& options, Callback callback)
+{
+    return measure(std::move(benchmark), std::move(corpus), options, [](size_t) {}, std::move(callback));
+}
+
+inline void print_results(std::vector<Result> const& results, FILE* stream = stdout)
+{
+    fprintf(stream, "%-28s %-24s %6s %11s %11s %11s %11s %11s", "benchmark", "corpus", "reps", "mean (us)", "p50", "p90", "p99", "max");
+    if (Allocations::is_compiled_in)
+        fprintf(stream, " %12s %12s", "allocs/iter", "bytes/iter");
+    fprintf(stream, "\n");
+    for (auto const& result : results) {
+        fprintf(stream, "%-28s %-24s %6zu %11.1f %11.1f %11.1f %11.1f %11.1f",
+            result.benchmark.c_str(), result.corpus.c_str(), result.repetitions, result.mean, result.p50, result.p90, result.p99, result.max);
+        if (result.allocations.has_value())
+            fprintf(stream, " %12lu %12lu", static_cast<unsigned long>(result.allocations->count), static_cast<unsigned long>(result.allocations->bytes));
+        fprintf(stream, "\n");
+    }
+
+    if (std::none_of(results.begin(), results.end(), [](auto const& result) { return result.hardware_events.has_value(); }))
+        return;
+    fprintf(stream, "\n%-28s %-24s %14s %14s %6s %12s %12s\n", "benchmark", "corpus", "cycles", "instructions", "IPC", "LLC misses", "br misses");
+    for (auto const& result : results) {
+        if (!result.hardware_events.has_value())
+            continue;
+        auto const& events = result.hardware_events.value();
+        double ipc = events.cycles == 0 ? 0 : static_cast<double>(events.instructions) / static_cast<double>(events.cycles);
+        fprintf(stream, "%-28s %-24s %14lu %14lu %6.2f %12lu %12lu\n", result.benchmark.c_str(), result.corpus.c_str(),
+            static_cast<unsigned long>(events.cycles), static_cast<unsigned long>(events.instructions), ipc,
+            static_cast<unsigned long>(events.cache_misses), static_cast<unsigned long>(events.branch_misses));
+    }
+}
+
+inline std::string escape_json(std::string_view string)
+{
+    std::string escaped;
+    for (auto character : string) {
+        if (character == '"' || character == '\\')
+            escaped += '\\';
+        if (static_cast<unsigned char>(character) < 0x20)
+            continue;
+        escaped += character;
+    }
+    return escaped;
+}
+
+inline void write_json(std::vector<Result> const& results, FILE* stream)
+{
+    fprintf(stream, "{\n  \"unit\": \"us\",\n  \"results\": [");
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto const& result = results[i];
+        fprintf(stream, "%s\n    { \"benchmark\": \"%s\", \"corpus\": \"%s\", \"repetitions\": %zu, \"min\": %.3f, \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f",
+            i == 0 ? "" : ",", escape_json(result.benchmark).c_str(), escape_json(result.corpus).c_str(), result.repetitions,
+            result.min, result.mean, result.p50, result.p90, result.p99, result.max);
+        if (result.hardware_events.has_value()) {
+            auto const& events = result.hardware_events.value();
+            fprintf(stream, ", \"cycles\": %lu, \"instructions\": %lu, \"cache_misses\": %lu, \"branch_misses\": %lu",
+                static_cast<unsigned long>(events.cycles), static_cast<unsigned long>(events.instructions),
+                static_cast<unsigned long>(events.cache_misses), static_cast<unsigned long>(events.branch_misses));
+        }
+        if (result.allocations.has_value()) {
+            fprintf(stream, ", \"allocations\": %lu, \"allocated_bytes\": %lu",
+                static_cast<unsigned long>(result.allocations->count), static_cast<unsigned long>(result.allocations->bytes));
+        }
+        fprintf(stream, " }");
+    }
+    fprintf(stream, "\n  ]\n}\n");
+}
+
+}
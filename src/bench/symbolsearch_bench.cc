@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+// Measures SymbolSearchIndex on a large project: searching with selective and short queries, and republishing the
+// declarations of a document (which removes its entries from the posting lists of common trigrams).
+//
+// Usage: symbolsearch-bench [DOCUMENTS] [DECLARATIONS_PER_DOCUMENT]
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench/harness.hh"
+#include "symbolsearchindex.hh"
+
+using namespace CodeComprehension;
+
+namespace {
+
+// Identifiers made of common words, so that their trigrams have long posting lists like in a real project.
+std::vector<Declaration> generate_declarations(std::mt19937& random, std::string const& file, size_t count)
+{
+    static constexpr char const* words[] = { "get", "set", "document", "data", "symbol", "name", "type", "node", "token",
+        "parse", "create", "find", "declaration", "scope", "member", "index", "path", "include", "header", "value" };
+    static constexpr size_t word_count = sizeof(words) / sizeof(words[0]);
+
+    std::vector<Declaration> declarations;
+    declarations.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string name = words[random() % word_count];
+        for (size_t part = random() % 3; part < 3; ++part)
+            name += std::string { "_" } + words[random() % word_count];
+        name += "_" + std::to_string(random() % 1000);
+        declarations.push_back({ std::move(name), { file, i, 0 }, DeclarationType::Function, "" });
+    }
+    return declarations;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t document_count = argc > 1 ? std::stoul(argv[1]) : 2000;
+    size_t declarations_per_document = argc > 2 ? std::stoul(argv[2]) : 100;
+
+    std::mt19937 random(1337);
+    std::vector<std::vector<Declaration>> documents;
+    for (size_t i = 0; i < document_count; ++i)
+        documents.push_back(generate_declarations(random, "file_" + std::to_string(i) + ".hh", declarations_per_document));
+
+    SymbolSearchIndex index;
+    for (size_t i = 0; i < document_count; ++i)
+        index.set_declarations_of_document("file_" + std::to_string(i) + ".hh", documents[i]);
+
+    auto corpus = std::to_string(index.size()) + " declarations";
+    Bench::Options options;
+    std::vector<Bench::Result> results;
+    size_t found = 0;
+
+    for (auto const* query : { "getdocdata", "find_declaration_of", "symnam", "gd" }) {
+        results.push_back(Bench::measure(std::string { "search \"" } + query + "\"", corpus, options, [&](size_t) {
+            found += index.search(query, 50).size();
+        }));
+    }
+
+    // Alternates between two versions of the declarations, so that every iteration really replaces them.
+    std::vector<std::vector<Declaration>> new_versions;
+    for (size_t i = 0; i < 2; ++i)
+        new_versions.push_back(generate_declarations(random, "file_0.hh", declarations_per_document));
+    results.push_back(Bench::measure("republish document", corpus, options, [&](size_t iteration) {
+        index.set_declarations_of_document("file_0.hh", new_versions[iteration % 2]);
+    }));
+
+    printf("%zu documents, %zu declarations per document (%zu found)\n\n", document_count, declarations_per_document, found);
+    Bench::print_results(results);
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "bloomfilter.hh"
+
+namespace CodeComprehension {
+
+BloomFilter::BloomFilter(size_t expected_element_count)
+    : m_words((expected_element_count * bits_per_element + 63) / 64 + 1, 0)
+{
+}
+
+uint64_t BloomFilter::hash(std::string_view string)
+{
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (auto ch : string) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void BloomFilter::add(std::string_view string)
+{
+    if (m_words.empty())
+        return;
+
+    // Derive all the bit positions from two halves of a single hash (Kirsch-Mitzenmacher).
+    auto string_hash = hash(string);
+    uint32_t h1 = static_cast<uint32_t>(string_hash);
+    uint32_t h2 = static_cast<uint32_t>(string_hash >> 32) | 1;
+    size_t bit_count = m_words.size() * 64;
+    for (size_t i = 0; i < hash_count; ++i) {
+        size_t bit = (h1 + i * h2) % bit_count;
+        m_words[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+bool BloomFilter::may_contain(std::string_view string) const
+{
+    // An empty filter was never sized, so it can't rule anything out.
+    if (m_words.empty())
+        return true;
+
+    auto string_hash = hash(string);
+    uint32_t h1 = static_cast<uint32_t>(string_hash);
+    uint32_t h2 = static_cast<uint32_t>(string_hash >> 32) | 1;
+    size_t bit_count = m_words.size() * 64;
+    for (size_t i = 0; i < hash_count; ++i) {
+        size_t bit = (h1 + i * h2) % bit_count;
+        if (!(m_words[bit / 64] & (uint64_t(1) << (bit % 64))))
+            return false;
+    }
+    return true;
+}
+
+}
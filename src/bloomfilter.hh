@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace CodeComprehension {
+
+// A set of strings that can answer "definitely not in the set" without storing the strings.
+// may_contain() has no false negatives and about 1% false positives when the filter was sized for the number of added strings.
+class BloomFilter {
+public:
+    BloomFilter() = default;
+    explicit BloomFilter(size_t expected_element_count);
+
+    void add(std::string_view);
+    bool may_contain(std::string_view) const;
+
+    size_t size_in_bytes() const { return m_words.size() * sizeof(uint64_t); }
+
+private:
+    static constexpr size_t bits_per_element = 10;
+    static constexpr size_t hash_count = 7;
+
+    static uint64_t hash(std::string_view);
+
+    std::vector<uint64_t> m_words;
+};
+
+}
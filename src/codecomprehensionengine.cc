@@ -6,6 +6,7 @@
  */
 
 #include "codecomprehensionengine.hh"
+#include "trace.hh"
 
 namespace CodeComprehension {
 
@@ -17,6 +18,8 @@ CodeComprehensionEngine::CodeComprehensionEngine(FileDB const& filedb, bool shou
 
 void CodeComprehensionEngine::set_declarations_of_document(std::string const& filename, std::vector<Declaration>&& declarations)
 {
+    m_symbol_search_index.set_declarations_of_document(filename, declarations);
+
     // Callback may not be configured if we're running tests
     if (!set_declarations_of_document_callback)
         return;
@@ -27,10 +30,38 @@ void CodeComprehensionEngine::set_declarations_of_document(std::string const& fi
             return;
     }
     if (m_store_all_declarations)
-        m_all_declarations.emplace(filename, declarations);
+        m_all_declarations.insert_or_assign(filename, declarations);
     set_declarations_of_document_callback(filename, move(declarations));
 }
 
+void CodeComprehensionEngine::remove_declarations_of_document(std::string const& filename)
+{
+    m_symbol_search_index.remove_document(filename);
+    m_all_declarations.erase(filename);
+    if (set_declarations_of_document_callback)
+        set_declarations_of_document_callback(filename, {});
+}
+
+std::vector<Declaration> CodeComprehensionEngine::search_workspace_symbols(std::string const& query, size_t limit) const
+{
+    TRACE_SCOPE_WITH(span, "search_workspace_symbols");
+    TRACE_ARG(span, "query", query);
+    auto timer = engine_statistics().time(EngineApi::SearchWorkspaceSymbols);
+    return m_symbol_search_index.search(query, limit);
+}
+
+Statistics CodeComprehensionEngine::statistics() const
+{
+    Statistics statistics;
+#define __ENGINE_API(x) statistics.latencies.push_back({ EngineApi::x, m_statistics.latency_of(EngineApi::x).summarize(), m_statistics.allocations_of(EngineApi::x) });
+    FOR_EACH_ENGINE_API
+#undef __ENGINE_API
+#define __ENGINE_COUNTER(x) statistics.counters.push_back({ EngineCounter::x, m_statistics.counter(EngineCounter::x) });
+    FOR_EACH_ENGINE_COUNTER
+#undef __ENGINE_COUNTER
+    return statistics;
+}
+
 void CodeComprehensionEngine::set_todo_entries_of_document(std::string const& filename, std::vector<TodoEntry>&& todo_entries)
 {
     // Callback may not be configured if we're running tests
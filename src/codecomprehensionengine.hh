@@ -9,10 +9,13 @@
 
 #include <vector>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <unordered_map>
 
 #include "filedb.hh"
+#include "statistics.hh"
+#include "symbolsearchindex.hh"
 #include "types.hh"
 #include "cpp_parser/parser.hh"
 
@@ -39,28 +42,63 @@ public:
     // TODO: In the future we can pass the range that was edited and only re-parse what we have to.
     virtual void on_edit([[maybe_unused]] std::string const& file) {};
     virtual void file_opened([[maybe_unused]] std::string const& file) {};
+    virtual void file_closed([[maybe_unused]] std::string const& file) {};
+    // Publishes the declarations and TODO entries of a document and of every header it includes.
+    virtual void index_document([[maybe_unused]] std::string const& file) {};
 
     virtual std::optional<ProjectLocation> find_declaration_of(std::string const&, GUI::TextPosition const&) { return {}; }
 
     struct FunctionParamsHint {
         std::vector<std::string> params;
         size_t current_index { 0 };
+        // The parameters of every overload of the function (including 'params'), so that editors can cycle through them.
+        std::vector<std::vector<std::string>> overloads;
     };
     virtual std::optional<FunctionParamsHint> get_function_params_hint(std::string const&, GUI::TextPosition const&) { return {}; }
 
     virtual std::vector<TokenInfo> get_tokens_info(std::string const&) { return {}; }
 
+    // The declarations of a document as a tree (namespace -> class -> members), in source order.
+    // The result is shared and stays valid after the document is re-parsed.
+    virtual std::shared_ptr<DocumentOutline const> document_outline(std::string const&) { return {}; }
+
+    struct DocumentMemoryUsage {
+        std::string file;
+        // An estimate of the memory held by the document's text, tokens, AST and symbol tables.
+        size_t bytes { 0 };
+        // Evicted documents only keep a summary of their includes, they are parsed again when a query needs them.
+        bool is_evicted { false };
+    };
+    virtual std::vector<DocumentMemoryUsage> memory_usage() const { return {}; }
+
+    // When the documents use more memory than this, the least recently used ones that aren't open are evicted.
+    // A budget of 0 (the default) means that documents are never evicted.
+    virtual void set_memory_budget([[maybe_unused]] size_t bytes) {};
+
+    // Fuzzy search over the declarations of every document we've parsed, best matches first.
+    virtual std::vector<Declaration> search_workspace_symbols(std::string const& query, size_t limit) const;
+
+    // Latencies of the public APIs, counters and the size of every document, see Statistics::to_text() and Statistics::to_json().
+    // Has to be called from the thread that uses the engine, since the documents aren't synchronized. Only the latencies,
+    // allocations and counters are atomic, see EngineStatistics.
+    virtual Statistics statistics() const;
+
     std::function<void(std::string const&, std::vector<Declaration>&&)> set_declarations_of_document_callback;
     std::function<void(std::string const&, std::vector<TodoEntry>&&)> set_todo_entries_of_document_callback;
 
 protected:
     FileDB const& filedb() const { return m_filedb; }
+    EngineStatistics& engine_statistics() const { return m_statistics; }
     void set_declarations_of_document(std::string const&, std::vector<Declaration>&&);
+    // For a document that is gone, e.g because its file was deleted.
+    void remove_declarations_of_document(std::string const&);
     void set_todo_entries_of_document(std::string const&, std::vector<TodoEntry>&&);
     std::unordered_map<std::string, std::vector<Declaration>> const& all_declarations() const { return m_all_declarations; }
 
 private:
     std::unordered_map<std::string, std::vector<Declaration>> m_all_declarations;
+    SymbolSearchIndex m_symbol_search_index;
+    mutable EngineStatistics m_statistics;
     FileDB const& m_filedb;
     bool m_store_all_declarations { false };
 };
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "corpusgenerator.hh"
+#include <algorithm>
+#include <optional>
+#include <string_view>
+
+namespace CodeComprehension {
+
+namespace {
+
+// SplitMix64, so that the output doesn't depend on the standard library's random distributions.
+class Random {
+public:
+    explicit Random(uint64_t seed)
+        : m_state(seed)
+    {
+    }
+
+    uint64_t next()
+    {
+        uint64_t value = (m_state += 0x9e3779b97f4a7c15);
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+        return value ^ (value >> 31);
+    }
+
+    size_t next_below(size_t bound) { return bound == 0 ? 0 : static_cast<size_t>(next() % bound); }
+
+    bool chance(double probability) { return static_cast<double>(next() >> 11) * 0x1.0p-53 < probability; }
+
+private:
+    uint64_t m_state;
+};
+
+struct ClassInfo {
+    // Fully qualified, e.g "project::level0_1::Class_0_3_1".
+    std::string name;
+    // The qualified name of the type of 'member_1' if it's a class of an included header.
+    std::optional<std::string> object_member_type;
+};
+
+struct HeaderInfo {
+    std::string path;
+    std::vector<ClassInfo> classes;
+    // Fully qualified names of the free functions, each takes a class of 'classes' and an int.
+    std::vector<std::string> functions;
+};
+
+std::string header_path(size_t level, size_t index)
+{
+    return "include/level" + std::to_string(level) + "/header_" + std::to_string(index) + ".hh";
+}
+
+std::string source_path(size_t index)
+{
+    return "src/source_" + std::to_string(index) + ".cc";
+}
+
+std::vector<std::string> namespaces_of_level(size_t level, size_t depth)
+{
+    std::vector<std::string> namespaces;
+    for (size_t i = 0; i < depth; ++i)
+        namespaces.push_back(i == 0 ? std::string { "project" } : "level" + std::to_string(level) + "_" + std::to_string(i));
+    return namespaces;
+}
+
+std::string qualified_name(std::vector<std::string> const& namespaces, std::string_view name)
+{
+    std::string result;
+    for (auto const& name_space : namespaces)
+        result += name_space + "::";
+    result += name;
+    return result;
+}
+
+// Picks 'count' different indices below 'bound'.
+std::vector<size_t> pick_distinct(Random& random, size_t count, size_t bound)
+{
+    std::vector<size_t> indices;
+    count = std::min(count, bound);
+    while (indices.size() < count) {
+        auto index = random.next_below(bound);
+        if (std::find(indices.begin(), indices.end(), index) == indices.end())
+            indices.push_back(index);
+    }
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+void append_nested_classes(std::string& out, size_t nesting, size_t depth, std::string const& indentation)
+{
+    if (depth > nesting)
+        return;
+    out += indentation + "struct Nested_" + std::to_string(depth) + " {\n";
+    out += indentation + "    int nested_member_" + std::to_string(depth) + ";\n";
+    append_nested_classes(out, nesting, depth + 1, indentation + "    ");
+    out += indentation + "};\n";
+}
+
+HeaderInfo generate_header(CorpusOptions const& options, Random& random, size_t level, size_t index, std::vector<HeaderInfo> const& next_level, std::string& out)
+{
+    HeaderInfo header { header_path(level, index), {}, {} };
+    auto tag = std::to_string(level) + "_" + std::to_string(index);
+
+    out += "#pragma once\n\n";
+
+    auto included_indices = pick_distinct(random, options.include_fan_out, next_level.size());
+    // Header i of every level includes header i of the next one, so that the back-edge of the last level always
+    // closes a cycle.
+    if (options.include_cycles && !next_level.empty() && std::find(included_indices.begin(), included_indices.end(), index) == included_indices.end()) {
+        included_indices.push_back(index);
+        std::sort(included_indices.begin(), included_indices.end());
+    }
+
+    std::vector<ClassInfo const*> included_classes;
+    for (auto included_index : included_indices) {
+        out += "#include \"" + next_level[included_index].path + "\"\n";
+        for (auto const& included_class : next_level[included_index].classes)
+            included_classes.push_back(&included_class);
+    }
+    // Header i of the last level includes header i + 1 of level 0, which leads back to it through the other levels.
+    // With a single level, the headers of level 0 include each other in a ring.
+    if (options.include_cycles && next_level.empty())
+        out += "#include \"" + header_path(0, (index + 1) % options.headers_per_level) + "\"\n";
+
+    out += "\n#define DECLARE_MEMBER_" + tag + "(type, name) type name;\n";
+    out += "#define DECLARE_METHOD_" + tag + "(name) int name(int first, int second);\n\n";
+
+    auto namespaces = namespaces_of_level(level, options.namespace_depth);
+    for (auto const& name_space : namespaces)
+        out += "namespace " + name_space + " {\n";
+    if (!namespaces.empty())
+        out += "\n";
+
+    for (size_t class_index = 0; class_index < options.classes_per_header; ++class_index) {
+        auto class_name = "Class_" + tag + "_" + std::to_string(class_index);
+        ClassInfo class_info { qualified_name(namespaces, class_name), {} };
+
+        out += "struct " + class_name + " {\n";
+        for (size_t member = 0; member < options.members_per_class; ++member) {
+            auto member_name = "member_" + std::to_string(member);
+            if (member == 1 && !included_classes.empty()) {
+                class_info.object_member_type = included_classes[random.next_below(included_classes.size())]->name;
+                out += "    " + class_info.object_member_type.value() + " " + member_name + ";\n";
+            } else if (random.chance(options.macro_density)) {
+                out += "    DECLARE_MEMBER_" + tag + "(int, " + member_name + ")\n";
+            } else {
+                out += "    int " + member_name + ";\n";
+            }
+        }
+        for (size_t method = 0; method < std::max<size_t>(1, options.members_per_class / 2); ++method) {
+            auto method_name = "method_" + std::to_string(method);
+            if (random.chance(options.macro_density))
+                out += "    DECLARE_METHOD_" + tag + "(" + method_name + ")\n";
+            else
+                out += "    int " + method_name + "(int first, int second);\n";
+        }
+        append_nested_classes(out, options.class_nesting, 1, "    ");
+        out += "};\n\n";
+
+        auto function_name = "function_" + tag + "_" + std::to_string(class_index);
+        out += "int " + function_name + "(" + class_name + " const& object, int value);\n\n";
+
+        header.classes.push_back(std::move(class_info));
+        header.functions.push_back(qualified_name(namespaces, function_name));
+    }
+
+    for (auto it = namespaces.rbegin(); it != namespaces.rend(); ++it)
+        out += "}\n";
+    return header;
+}
+
+void generate_source(CorpusOptions const& options, Random& random, size_t index, std::vector<HeaderInfo> const& first_level, std::string& out)
+{
+    auto macro_name = "TWICE_" + std::to_string(index);
+
+    auto included_headers = pick_distinct(random, options.include_fan_out, first_level.size());
+    for (auto included_index : included_headers)
+        out += "#include \"" + first_level[included_index].path + "\"\n";
+    out += "\n#define " + macro_name + "(x) ((x) * 2)\n\n";
+
+    size_t function_index = 0;
+    for (auto included_index : included_headers) {
+        auto const& header = first_level[included_index];
+        for (size_t class_index = 0; class_index < header.classes.size(); ++class_index) {
+            auto const& class_info = header.classes[class_index];
+            out += "int source_" + std::to_string(index) + "_function_" + std::to_string(function_index++) + "(int argument)\n{\n";
+            out += "    " + class_info.name + " object;\n";
+            out += "    object.member_0 = argument;\n";
+            if (class_info.object_member_type.has_value())
+                out += "    object.member_1.member_0 = argument;\n";
+            out += "    int result = object.method_0(argument, object.member_0);\n";
+            if (random.chance(options.macro_density))
+                out += "    result = " + macro_name + "(result);\n";
+            out += "    result += " + header.functions[class_index] + "(object, result);\n";
+            out += "    return result;\n}\n\n";
+        }
+    }
+
+    out += "int main()\n{\n    int total = 0;\n";
+    for (size_t i = 0; i < function_index; ++i)
+        out += "    total += source_" + std::to_string(index) + "_function_" + std::to_string(i) + "(" + std::to_string(i) + ");\n";
+    out += "    return total;\n}\n";
+}
+
+}
+
+std::vector<GeneratedFile> generate_corpus(CorpusOptions const& options)
+{
+    Random random(options.seed);
+    std::vector<GeneratedFile> files;
+
+    // Headers are generated from the deepest level up, so that a header knows the classes of the headers it includes.
+    std::vector<HeaderInfo> next_level;
+    for (size_t level = options.include_depth; level-- > 0;) {
+        std::vector<HeaderInfo> current_level;
+        for (size_t index = 0; index < options.headers_per_level; ++index) {
+            std::string content;
+            current_level.push_back(generate_header(options, random, level, index, next_level, content));
+            files.push_back({ current_level.back().path, std::move(content) });
+        }
+        next_level = std::move(current_level);
+    }
+
+    for (size_t index = 0; index < options.source_count; ++index) {
+        std::string content;
+        generate_source(options, random, index, next_level, content);
+        files.push_back({ source_path(index), std::move(content) });
+    }
+    return files;
+}
+
+}
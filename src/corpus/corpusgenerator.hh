@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CodeComprehension {
+
+// Generates synthetic C++ projects for stress tests and benchmarks.
+//
+// Headers are arranged in levels: the sources include headers of level 0, and a header of level n includes
+// headers of level n + 1. Every header declares classes (with members of the types of the headers it includes),
+// free functions and macros inside of nested namespaces. The sources use all of them, so that queries in a
+// source file have to look through the whole include tree.
+//
+// The output only depends on the options, the same options always generate the same project.
+struct CorpusOptions {
+    size_t source_count { 8 };
+    // The number of levels of headers, 0 means that the sources don't include anything.
+    size_t include_depth { 3 };
+    size_t headers_per_level { 8 };
+    // How many headers of the next level every source and header includes.
+    size_t include_fan_out { 3 };
+    size_t namespace_depth { 2 };
+    // How deep classes are nested inside of each other, 0 means no nested classes.
+    size_t class_nesting { 1 };
+    size_t classes_per_header { 4 };
+    size_t members_per_class { 6 };
+    // The fraction of members and functions that are declared through a macro, between 0 and 1.
+    double macro_density { 0.1 };
+    // If set, the headers of the last level include a header of level 0, which closes an include cycle (even with
+    // a single level). Every header then also includes the header with its own index of the next level.
+    // Just like a real include cycle without forward declarations, this makes the project fail to compile.
+    bool include_cycles { false };
+    uint64_t seed { 1 };
+};
+
+struct GeneratedFile {
+    // Relative to the root of the project, which is also how the files #include each other.
+    std::string path;
+    std::string content;
+
+    bool operator==(GeneratedFile const&) const = default;
+};
+
+std::vector<GeneratedFile> generate_corpus(CorpusOptions const&);
+
+}
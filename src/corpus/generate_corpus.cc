@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+// Writes a synthetic project to a directory, see CorpusOptions for what the options mean.
+// The project can be passed to the bench target with --corpus.
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "corpus/corpusgenerator.hh"
+
+using namespace CodeComprehension;
+
+static int usage(char const* program)
+{
+    fprintf(stderr,
+        "Usage: %s [options] OUTPUT_DIRECTORY\n"
+        "  --sources N            number of source files\n"
+        "  --include-depth N      levels of headers\n"
+        "  --headers-per-level N\n"
+        "  --fan-out N            headers included by every source and header\n"
+        "  --namespace-depth N\n"
+        "  --class-nesting N\n"
+        "  --classes N            classes per header\n"
+        "  --members N            members per class\n"
+        "  --macro-density F      fraction of declarations that go through a macro\n"
+        "  --include-cycles       close an include cycle from the last level of headers\n"
+        "  --seed N\n",
+        program);
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    CorpusOptions options;
+    std::optional<std::filesystem::path> output_directory;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view argument = argv[i];
+        if (argument == "--include-cycles") {
+            options.include_cycles = true;
+            continue;
+        }
+        if (!argument.starts_with("--")) {
+            output_directory = argument;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return usage(argv[0]);
+        std::string value = argv[++i];
+
+        if (argument == "--sources")
+            options.source_count = std::stoul(value);
+        else if (argument == "--include-depth")
+            options.include_depth = std::stoul(value);
+        else if (argument == "--headers-per-level")
+            options.headers_per_level = std::stoul(value);
+        else if (argument == "--fan-out")
+            options.include_fan_out = std::stoul(value);
+        else if (argument == "--namespace-depth")
+            options.namespace_depth = std::stoul(value);
+        else if (argument == "--class-nesting")
+            options.class_nesting = std::stoul(value);
+        else if (argument == "--classes")
+            options.classes_per_header = std::stoul(value);
+        else if (argument == "--members")
+            options.members_per_class = std::stoul(value);
+        else if (argument == "--macro-density")
+            options.macro_density = std::stod(value);
+        else if (argument == "--seed")
+            options.seed = std::stoull(value);
+        else
+            return usage(argv[0]);
+    }
+    if (!output_directory.has_value())
+        return usage(argv[0]);
+
+    size_t line_count = 0;
+    auto files = generate_corpus(options);
+    for (auto const& file : files) {
+        auto path = output_directory.value() / file.path;
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+        std::ofstream stream(path);
+        if (error || !stream) {
+            fprintf(stderr, "Unable to write %s\n", path.c_str());
+            return 1;
+        }
+        stream << file.content;
+        line_count += std::count(file.content.begin(), file.content.end(), '\n');
+    }
+
+    printf("Wrote %zu files (%zu lines) to %s\n", files.size(), line_count, output_directory->c_str());
+    return 0;
+}
@@ -5,7 +5,9 @@
  */
 
 #include "cppcomprehensionengine.hh"
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <regex>
 #include <filesystem>
 
@@ -13,26 +15,10 @@
 #include "cpp_parser/lexer.hh"
 #include "cpp_parser/parser.hh"
 #include "cpp_parser/preprocessor.hh"
+#include "../trace.hh"
 
 constexpr bool CPP_LANGUAGE_SERVER_DEBUG = false;
 
-std::vector<std::string_view> split_view(const std::string_view str, const std::string_view delimiter) {
-    std::vector<std::string_view> result;
-    size_t pos = 0;
-
-    while (pos != std::string_view::npos) {
-        size_t nextPos = str.find(delimiter, pos);
-        if (nextPos == std::string_view::npos) {
-            result.push_back(str.substr(pos));
-        } else {
-            result.push_back(str.substr(pos, nextPos - pos));
-        }
-        pos = (nextPos == std::string_view::npos) ? nextPos : nextPos + delimiter.size();
-    }
-
-    return result;
-}
-
 namespace CodeComprehension::Cpp {
 
 CppComprehensionEngine::CppComprehensionEngine(FileDB const& filedb)
@@ -43,11 +29,16 @@ CppComprehensionEngine::CppComprehensionEngine(FileDB const& filedb)
 CppComprehensionEngine::DocumentData const* CppComprehensionEngine::get_or_create_document_data(std::string const& file)
 {
     auto absolute_path = filedb().to_absolute_path(file);
-    if (!m_documents.contains(absolute_path)) {
-        auto owner = std::move(create_document_data_for(absolute_path));
-        set_document_data(absolute_path, std::move(owner));
+    if (auto const* document = get_document_data(absolute_path); !document) {
+        set_document_data(absolute_path, create_document_data_for(absolute_path));
+    } else if (document->m_is_evicted && !rehydrate_document(absolute_path)) {
+        return nullptr;
     }
-    return get_document_data(absolute_path);
+
+    auto const* document = get_document_data(absolute_path);
+    if (document)
+        mark_as_used(*document);
+    return document;
 }
 
 CppComprehensionEngine::DocumentData const* CppComprehensionEngine::get_document_data(std::string const& file) const
@@ -59,14 +50,32 @@ CppComprehensionEngine::DocumentData const* CppComprehensionEngine::get_document
     return document_data->second.get();
 }
 
+CppComprehensionEngine::DocumentData const* CppComprehensionEngine::document_of_declaration(Cpp::Declaration const& declaration) const
+{
+    // Documents are always parsed with their absolute path as the filename, so we don't have to canonicalize it again.
+    auto document_data = m_documents.find(std::string { declaration.filename() });
+    if (document_data == m_documents.end())
+        return nullptr;
+    return document_data->second.get();
+}
+
 std::unique_ptr<CppComprehensionEngine::DocumentData> CppComprehensionEngine::create_document_data_for(std::string const& file)
 {
     if (m_unfinished_documents.contains(file)) {
         return {};
     }
     m_unfinished_documents.emplace(file);
-    ScopeGuard mark_finished([&file, this]() { m_unfinished_documents.erase(file); });
-    auto document = filedb().get_or_read_from_filesystem(file);
+    ScopeGuard mark_finished([&file, this]() {
+        m_unfinished_documents.erase(file);
+        if (m_unfinished_documents.empty())
+            m_unreadable_include_paths.clear();
+    });
+    std::optional<std::string> document;
+    {
+        TRACE_SCOPE_WITH(span, "read file");
+        TRACE_ARG(span, "file", file);
+        document = filedb().get_or_read_from_filesystem(file);
+    }
     if (!document.has_value())
         return {};
     return create_document_data(move(document.value()), file);
@@ -74,21 +83,89 @@ std::unique_ptr<CppComprehensionEngine::DocumentData> CppComprehensionEngine::cr
 
 void CppComprehensionEngine::set_document_data(std::string const& file, std::unique_ptr<DocumentData>&& data)
 {
-    m_documents.emplace(filedb().to_absolute_path(file), move(data));
+    auto absolute_path = filedb().to_absolute_path(file);
+
+    // The memoized definitions of the previous version of this document are stale now.
+    if (auto it = m_include_paths_of_headers.find(absolute_path); it != m_include_paths_of_headers.end()) {
+        for (auto const& include_path : it->second) {
+            if (auto header = m_included_headers.find(include_path); header != m_included_headers.end()) {
+                m_included_headers_memory_usage -= header->second.memory_usage;
+                m_included_headers.erase(header);
+            }
+        }
+        m_include_paths_of_headers.erase(it);
+    }
+
+    // Nothing refers to an evicted document, its eviction already dropped the caches that did.
+    // That's what makes rehydrating documents in the middle of a query safe, see parsed_document().
+    if (auto const* previous_document = get_document_data(absolute_path); previous_document && !previous_document->m_is_evicted)
+        ++m_documents_generation;
+
+    // A document that couldn't be read (or is part of an #include cycle that is being parsed) is not stored,
+    // so every entry of m_documents is a valid document.
+    if (!data) {
+        if (auto it = m_documents.find(absolute_path); it != m_documents.end()) {
+            auto filename = it->second->filename();
+            m_documents.erase(absolute_path);
+            remove_declarations_of_document(filename);
+        }
+        return;
+    }
+    m_documents.insert_or_assign(move(absolute_path), move(data));
+}
+
+CppComprehensionEngine::IncludedHeader const* CppComprehensionEngine::get_or_create_included_header(std::string_view include_path)
+{
+    auto key = std::string { include_path };
+    if (auto it = m_included_headers.find(key); it != m_included_headers.end()) {
+        engine_statistics().increment(EngineCounter::IncludeResolutionHits);
+        return &it->second;
+    }
+    if (m_unreadable_include_paths.contains(key)) {
+        engine_statistics().increment(EngineCounter::IncludeResolutionHits);
+        return nullptr;
+    }
+    engine_statistics().increment(EngineCounter::IncludeResolutionMisses);
+
+    auto path = document_path_from_include_path(include_path);
+    auto absolute_path = filedb().to_absolute_path(path);
+    auto const* included_document = get_or_create_document_data(path);
+    if (!included_document) {
+        // Every includer resolves its includes twice (see create_document_data()), so remember that the header couldn't be read.
+        // A header that is part of an #include cycle will be stored once it's parsed.
+        if (!m_unfinished_documents.contains(absolute_path))
+            m_unreadable_include_paths.emplace(move(key));
+        return nullptr;
+    }
+
+    // Creating the header may have re-entered this function for the same path (through its own includes).
+    if (auto it = m_included_headers.find(key); it != m_included_headers.end())
+        return &it->second;
+
+    IncludedHeader header { absolute_path, std::make_shared<Preprocessor::Definitions const>(included_document->preprocessor().definitions()), included_document->m_has_include_guard };
+    for (auto const& [name, definition] : *header.definitions)
+        header.memory_usage += sizeof(Preprocessor::Definitions::value_type) + name.capacity() + definition.value.capacity();
+    m_included_headers_memory_usage += header.memory_usage;
+    m_include_paths_of_headers[absolute_path].push_back(key);
+    return &m_included_headers.emplace(move(key), move(header)).first->second;
 }
 
 std::vector<CodeComprehension::AutocompleteResultEntry> CppComprehensionEngine::get_suggestions(std::string const& file, const GUI::TextPosition& autocomplete_position)
 {
+    TRACE_SCOPE_WITH(span, "get_suggestions");
+    TRACE_ARG(span, "file", file);
+    auto timer = engine_statistics().time(EngineApi::GetSuggestions);
+    auto arena_scope = m_request_arena.scope();
     Cpp::Position position { autocomplete_position.line(), autocomplete_position.column() > 0 ? autocomplete_position.column() - 1 : 0 };
 
     //dbgln("CppComprehensionEngine position {}:{}", position.line, position.column);
 
-    auto const* document_ptr = get_or_create_document_data(file);
+    auto const* document_ptr = get_or_create_indexed_document_data(file);
     if (!document_ptr)
         return {};
 
     auto const& document = *document_ptr;
-    auto containing_token = document.parser().token_at(position);
+    auto containing_token = document.token_at(position);
 
     if (containing_token.has_value() && containing_token->type() == Token::Type::IncludePath) {
         auto results = try_autocomplete_include(document, containing_token.value(), position);
@@ -96,7 +173,7 @@ std::vector<CodeComprehension::AutocompleteResultEntry> CppComprehensionEngine::
             return results.value();
     }
 
-    auto node = document.parser().node_at(position);
+    auto node = document.node_at(position);
     if (!node) {
         //dbgln("no node at position {}:{}", position.line, position.column);
         return {};
@@ -170,18 +247,19 @@ std::vector<CodeComprehension::AutocompleteResultEntry> CppComprehensionEngine::
         return true;
     };
 
-    std::vector<Symbol> matches;
+    std::pmr::vector<Symbol const*> matches(&m_request_arena);
 
     for_each_available_symbol(document, [&](Symbol const& symbol) {
         if (symbol_matches(symbol)) {
-            matches.push_back(symbol);
+            matches.push_back(&symbol);
         }
         return IterationDecision::Continue;
     });
 
     std::vector<CodeComprehension::AutocompleteResultEntry> suggestions;
-    for (auto& symbol : matches) {
-        suggestions.push_back({ std::string{symbol.name.name}, partial_text.length() });
+    suggestions.reserve(matches.size());
+    for (auto const* symbol : matches) {
+        suggestions.push_back({ std::string{symbol->name.name}, partial_text.length() });
     }
 
     if (reference_scope.empty()) {
@@ -195,7 +273,7 @@ std::vector<CodeComprehension::AutocompleteResultEntry> CppComprehensionEngine::
     return suggestions;
 }
 
-std::vector<std::string_view> CppComprehensionEngine::scope_of_reference_to_symbol(ASTNode const& node) const
+CppComprehensionEngine::ScopeParts CppComprehensionEngine::scope_of_reference_to_symbol(ASTNode const& node) const
 {
     Name const* name = nullptr;
     if (node.is_name()) {
@@ -204,15 +282,15 @@ std::vector<std::string_view> CppComprehensionEngine::scope_of_reference_to_symb
     } else if (node.is_identifier()) {
         auto* parent = node.parent();
         if (!(parent && parent->is_name()))
-            return {};
+            return ScopeParts(&m_request_arena);
         name = reinterpret_cast<Name const*>(parent);
     } else {
-        return {};
+        return ScopeParts(&m_request_arena);
     }
 
     assert(name->is_name());
 
-    std::vector<std::string_view> scope_parts;
+    ScopeParts scope_parts(&m_request_arena);
     for (auto& scope_part : name->scope()) {
         // If the target node is part of a scope reference, we want to end the scope chain before it.
         if (scope_part == &node)
@@ -253,7 +331,7 @@ std::string CppComprehensionEngine::type_of_property(DocumentData const& documen
 {
     auto& parent = assert_cast<MemberExpression>(*identifier.parent());
     assert(parent.object());
-    auto properties = properties_of_type(document, type_of(document, *parent.object()));
+    auto const& properties = properties_of_type(document, type_of(document, *parent.object()));
     for (auto& prop : properties) {
         if (prop.name.name != identifier.name())
             continue;
@@ -295,6 +373,16 @@ std::string CppComprehensionEngine::type_of_variable(Identifier const& identifie
 }
 
 std::string CppComprehensionEngine::type_of(DocumentData const& document, Expression const& expression) const
+{
+    drop_stale_caches(document);
+    if (auto it = document.m_types_of_expressions.find(&expression); it != document.m_types_of_expressions.end())
+        return it->second;
+
+    auto type = compute_type_of(document, expression);
+    return document.m_types_of_expressions.emplace(&expression, move(type)).first->second;
+}
+
+std::string CppComprehensionEngine::compute_type_of(DocumentData const& document, Expression const& expression) const
 {
     if (expression.is_member_expression()) {
         auto& member_expression = assert_cast<MemberExpression>(expression);
@@ -320,57 +408,136 @@ std::string CppComprehensionEngine::type_of(DocumentData const& document, Expres
     return type_of_variable(*identifier);
 }
 
-std::vector<CppComprehensionEngine::Symbol> CppComprehensionEngine::properties_of_type(DocumentData const& document, std::string const& type) const
+std::vector<CppComprehensionEngine::Symbol> const& CppComprehensionEngine::properties_of_type(DocumentData const& document, std::string const& type) const
 {
-    auto type_symbol = SymbolName::create(type);
-    auto decl = find_declaration_of(document, type_symbol);
+    static std::vector<Symbol> const no_properties;
+
+    auto decl = find_declaration_of_type(document, type);
     if (!decl) {
         //dbgln("Couldn't find declaration of type: {}", type);
-        return {};
+        return no_properties;
     }
 
     if (!decl->is_struct_or_class()) {
         //dbgln("Expected declaration of type: {} to be struct or class", type);
-        return {};
+        return no_properties;
     }
 
-    auto& struct_or_class = assert_cast<StructOrClassDeclaration>(*decl);
-    assert(struct_or_class.full_name() == type_symbol.name);
+    return members_of(document, assert_cast<StructOrClassDeclaration>(*decl));
+}
+
+std::vector<CppComprehensionEngine::Symbol> const& CppComprehensionEngine::members_of(DocumentData const& document, StructOrClassDeclaration const& struct_or_class) const
+{
+    drop_stale_caches(document);
+    if (auto it = document.m_flattened_member_tables.find(&struct_or_class); it != document.m_flattened_member_tables.end())
+        return it->second;
+
+    // Insert the entry before resolving base classes, so that an inheritance cycle ends at the (still empty) entry instead of recursing forever.
+    auto& flattened_members = document.m_flattened_member_tables[&struct_or_class];
+
+    std::vector<Symbol> members;
+    if (auto const* declaring_document = document_of_declaration(struct_or_class)) {
+        if (auto it = declaring_document->m_member_tables.find(&struct_or_class); it != declaring_document->m_member_tables.end())
+            members = it->second;
+    }
 
-    std::vector<Symbol> properties;
-    for (auto& member : struct_or_class.members()) {
-        std::vector<std::string_view> scope(type_symbol.scope);
-        scope.push_back(type_symbol.name);
-        // FIXME: We don't have to create the Symbol here, it should already exist in the 'm_symbol' table of some DocumentData we already parsed.
-        properties.push_back(Symbol::create(member->full_name(), scope, member, Symbol::IsLocal::No));
+    // Members of a derived class hide members of its base classes that have the same name.
+    std::unordered_set<std::string_view> own_member_names;
+    // A base class that is reached through several paths (e.g "struct D : B, C" where B and C derive from A)
+    // contributes its members once.
+    std::unordered_set<Cpp::Declaration const*> member_declarations;
+    for (auto& member : members) {
+        own_member_names.emplace(member.name.name);
+        member_declarations.emplace(member.declaration);
     }
-    return properties;
+
+    for (auto& base_class : struct_or_class.baseclasses()) {
+        auto base_declaration = find_declaration_of_base_class(document, struct_or_class, *base_class);
+        if (!base_declaration || !base_declaration->is_struct_or_class() || base_declaration == &struct_or_class)
+            continue;
+        for (auto& member : members_of(document, assert_cast<StructOrClassDeclaration>(*base_declaration))) {
+            if (!own_member_names.contains(member.name.name) && member_declarations.insert(member.declaration).second)
+                members.push_back(member);
+        }
+    }
+
+    flattened_members = move(members);
+    return flattened_members;
+}
+
+Cpp::Declaration const* CppComprehensionEngine::find_declaration_of_base_class(DocumentData const& document, StructOrClassDeclaration const& struct_or_class, Name const& base_class) const
+{
+    auto base_class_name = std::string { base_class.full_name() };
+
+    // The base class may be named relative to the namespaces that enclose the derived class, so try the innermost one first.
+    auto scope = scope_of_node(struct_or_class);
+    while (!scope.empty()) {
+        std::string qualified_name;
+        for (auto& scope_part : scope)
+            qualified_name.append(fmt::format("{}::", scope_part));
+        qualified_name.append(base_class_name);
+
+        auto decl = find_declaration_of_type(document, qualified_name);
+        if (decl)
+            return decl;
+        scope.pop_back();
+    }
+    return find_declaration_of_type(document, base_class_name);
 }
 
-CppComprehensionEngine::Symbol CppComprehensionEngine::Symbol::create(std::string_view name, std::vector<std::string_view> const& scope, intrusive_ptr<Cpp::Declaration const> declaration, IsLocal is_local)
+Cpp::Declaration const* CppComprehensionEngine::find_declaration_of_property(DocumentData const& document, Identifier const& identifier) const
 {
-    std::vector<std::string_view> resultant_scope_vector;
+    auto& parent = assert_cast<MemberExpression>(*identifier.parent());
+    assert(parent.object());
+    auto const& object = *parent.object();
+    if (!object.is_member_expression() && !object.is_name() && !object.is_identifier())
+        return {};
 
-    for(auto const& scope_entry : scope) {
-        auto parts = split_view(scope_entry, "::");
-        for(auto const& part : parts)
-            resultant_scope_vector.push_back(part);
+    for (auto& prop : properties_of_type(document, type_of(document, object))) {
+        if (prop.name.name == identifier.name())
+            return prop.declaration;
     }
+    return {};
+}
+
+Cpp::Declaration const* CppComprehensionEngine::find_declaration_of_type(DocumentData const& document, std::string const& type) const
+{
+    drop_stale_caches(document);
+    if (auto it = document.m_declarations_of_types.find(type); it != document.m_declarations_of_types.end())
+        return it->second;
+
+    auto decl = find_declaration_of(document, SymbolName::create(type, m_request_arena));
+    document.m_declarations_of_types.emplace(type, decl);
+    return decl;
+}
 
-    return { { name, resultant_scope_vector }, std::move(declaration), is_local == IsLocal::Yes };
+void CppComprehensionEngine::drop_stale_caches(DocumentData const& document) const
+{
+    if (document.m_caches_generation == m_documents_generation)
+        return;
+    document.m_caches_generation = m_documents_generation;
+    document.m_declarations_of_types.clear();
+    document.m_flattened_member_tables.clear();
+    document.m_types_of_expressions.clear();
 }
 
-std::vector<CppComprehensionEngine::Symbol> CppComprehensionEngine::get_child_symbols(ASTNode const& node) const
+CppComprehensionEngine::Symbol CppComprehensionEngine::Symbol::create(std::string_view name, std::span<std::string_view const> scope, Cpp::Declaration const& declaration, IsLocal is_local, std::pmr::memory_resource& memory_resource)
 {
-    return get_child_symbols(node, {}, Symbol::IsLocal::No);
+    return { SymbolName::create(name, scope, memory_resource), &declaration, is_local == IsLocal::Yes };
 }
 
-std::vector<CppComprehensionEngine::Symbol> CppComprehensionEngine::get_child_symbols(ASTNode const& node, std::vector<std::string_view> const& scope, Symbol::IsLocal is_local) const
+std::vector<CppComprehensionEngine::Symbol> CppComprehensionEngine::get_child_symbols(ASTNode const& node, std::pmr::memory_resource& memory_resource) const
 {
     std::vector<Symbol> symbols;
+    std::vector<std::string_view> scope;
+    collect_child_symbols(node, scope, Symbol::IsLocal::No, memory_resource, symbols);
+    return symbols;
+}
 
+void CppComprehensionEngine::collect_child_symbols(ASTNode const& node, std::vector<std::string_view>& scope, Symbol::IsLocal is_local, std::pmr::memory_resource& memory_resource, std::vector<Symbol>& symbols) const
+{
     for (auto const& decl : node.declarations()) {
-        symbols.push_back(Symbol::create(decl->full_name(), scope, decl, is_local));
+        symbols.push_back(Symbol::create(decl->full_name(), scope, *decl, is_local, memory_resource));
 
         bool should_recurse = decl->is_namespace() || decl->is_struct_or_class() || decl->is_function();
         bool are_child_symbols_local = decl->is_function();
@@ -378,13 +545,45 @@ std::vector<CppComprehensionEngine::Symbol> CppComprehensionEngine::get_child_sy
         if (!should_recurse)
             continue;
 
-        auto new_scope = scope;
-        new_scope.push_back(decl->full_name());
-        auto child_symbols = get_child_symbols(*decl.get(), new_scope, are_child_symbols_local ? Symbol::IsLocal::Yes : is_local);
-        symbols.insert(symbols.end(), child_symbols.begin(), child_symbols.end());
+        scope.push_back(decl->full_name());
+        collect_child_symbols(*decl.get(), scope, are_child_symbols_local ? Symbol::IsLocal::Yes : is_local, memory_resource, symbols);
+        scope.pop_back();
     }
+}
 
-    return symbols;
+std::shared_ptr<DocumentOutline const> CppComprehensionEngine::document_outline(std::string const& filename)
+{
+    TRACE_SCOPE_WITH(span, "document_outline");
+    TRACE_ARG(span, "file", filename);
+    auto timer = engine_statistics().time(EngineApi::DocumentOutline);
+    auto const* document_ptr = get_or_create_document_data(filename);
+    if (!document_ptr)
+        return {};
+
+    auto const& document = *document_ptr;
+    if (!document.m_outline) {
+        DocumentOutline outline;
+        collect_outline_nodes(document, *document.parser().root_node(), {}, outline);
+        document.m_outline = std::make_shared<DocumentOutline const>(move(outline));
+    }
+    return document.m_outline;
+}
+
+void CppComprehensionEngine::collect_outline_nodes(DocumentData const& document, ASTNode const& node, std::string const& scope, std::vector<OutlineNode>& nodes) const
+{
+    auto declarations = node.declarations();
+    nodes.reserve(nodes.size() + declarations.size());
+    for (auto const& decl : declarations) {
+        auto name = std::string { decl->full_name() };
+        nodes.push_back({ { name, { document.filename(), decl->start().line, decl->start().column }, type_of_declaration(*decl), scope }, {} });
+
+        // Locals of functions are not part of the outline.
+        if (!decl->is_namespace() && !decl->is_struct_or_class())
+            continue;
+
+        auto child_scope = scope.empty() ? name : fmt::format("{}::{}", scope, name);
+        collect_outline_nodes(document, *decl, child_scope, nodes.back().children);
+    }
 }
 
 std::string CppComprehensionEngine::document_path_from_include_path(std::string_view include_path) const
@@ -417,17 +616,290 @@ std::string CppComprehensionEngine::document_path_from_include_path(std::string_
 
 void CppComprehensionEngine::on_edit(std::string const& file)
 {
-    set_document_data(file, create_document_data_for(file));
+    TRACE_SCOPE_WITH(span, "on_edit");
+    TRACE_ARG(span, "file", file);
+    auto timer = engine_statistics().time(EngineApi::OnEdit);
+    auto in_use_since = m_use_clock;
+    auto absolute_path = filedb().to_absolute_path(file);
+    m_open_documents.emplace(absolute_path);
+    engine_statistics().increment(EngineCounter::Reparses);
+    set_document_data(absolute_path, create_document_data_for(absolute_path));
+
+    // The host wants to see the declarations and TODOs of documents that are being edited right away.
+    if (auto const* document = get_document_data(absolute_path)) {
+        mark_as_used(*document);
+        publish_document(*document);
+    }
+    enforce_memory_budget(in_use_since);
 }
 
 void CppComprehensionEngine::file_opened([[maybe_unused]] std::string const& file)
 {
-    get_or_create_document_data(file);
+    TRACE_SCOPE_WITH(span, "file_opened");
+    TRACE_ARG(span, "file", file);
+    auto timer = engine_statistics().time(EngineApi::FileOpened);
+    auto in_use_since = m_use_clock;
+    m_open_documents.emplace(filedb().to_absolute_path(file));
+    if (auto const* document = get_or_create_document_data(file))
+        publish_document(*document);
+    enforce_memory_budget(in_use_since);
+}
+
+void CppComprehensionEngine::file_closed(std::string const& file)
+{
+    m_open_documents.erase(filedb().to_absolute_path(file));
+    enforce_memory_budget(m_use_clock);
+}
+
+void CppComprehensionEngine::index_document(std::string const& file)
+{
+    TRACE_SCOPE_WITH(span, "index_document");
+    TRACE_ARG(span, "file", file);
+    auto timer = engine_statistics().time(EngineApi::IndexDocument);
+    auto const* document = get_or_create_indexed_document_data(file);
+    if (!document)
+        return;
+
+    publish_document(*document);
+    for_each_included_document_recursive(*document, [&](DocumentData const& included_document) {
+        // Unless it was evicted before anything asked for it, an evicted document was published before.
+        if (included_document.m_is_evicted && included_document.m_are_symbols_declared && included_document.m_are_todo_entries_published)
+            return IterationDecision::Continue;
+        if (auto const* parsed = parsed_document(included_document))
+            publish_document(*parsed);
+        return IterationDecision::Continue;
+    });
+}
+
+CppComprehensionEngine::DocumentData const* CppComprehensionEngine::get_or_create_indexed_document_data(std::string const& file)
+{
+    auto in_use_since = m_use_clock;
+    auto const* document = get_or_create_document_data(file);
+    if (!document)
+        return nullptr;
+
+    // The headers in the include closure are only parsed again (or get their symbol tables) when a lookup needs them,
+    // see parsed_document(). Those stay until the budget is enforced by the next request.
+    ensure_symbols_are_declared(*document);
+
+    enforce_memory_budget(in_use_since);
+    return document;
+}
+
+CppComprehensionEngine::DocumentData& CppComprehensionEngine::document_for_update(DocumentData const& document)
+{
+    auto it = m_documents.find(document.filename());
+    assert(it != m_documents.end() && it->second.get() == &document);
+    return *it->second;
+}
+
+void CppComprehensionEngine::ensure_symbols_are_declared(DocumentData const& document)
+{
+    assert(!document.m_is_evicted);
+    if (document.m_are_symbols_declared)
+        return;
+    auto& mutable_document = document_for_update(document);
+    engine_statistics().increment(EngineCounter::SymbolTableBuilds);
+    update_declared_symbols(mutable_document);
+    mutable_document.m_are_symbols_declared = true;
+    mutable_document.m_memory_usage = mutable_document.compute_memory_usage();
+}
+
+void CppComprehensionEngine::publish_document(DocumentData const& document)
+{
+    ensure_symbols_are_declared(document);
+    if (document.m_are_todo_entries_published)
+        return;
+    auto& mutable_document = document_for_update(document);
+    update_todo_entries(mutable_document);
+    mutable_document.m_are_todo_entries_published = true;
+}
+
+void CppComprehensionEngine::mark_as_used(DocumentData const& document)
+{
+    document.m_last_use = ++m_use_clock;
+}
+
+bool CppComprehensionEngine::may_declare(DocumentData const& document, std::string_view name)
+{
+    // The names are only known once the symbol table was built, an evicted document keeps them.
+    return !document.m_are_symbols_declared || document.m_symbol_names.may_contain(name);
+}
+
+CppComprehensionEngine::DocumentData const* CppComprehensionEngine::parsed_document(DocumentData const& document) const
+{
+    if (!document.m_is_evicted && document.m_are_symbols_declared)
+        return &document;
+
+    // Rehydrating a document and building its symbol table only fill in what eviction (or laziness) left out,
+    // they don't change the result of any query, so lookups may do it.
+    auto& engine = const_cast<CppComprehensionEngine&>(*this);
+    auto const* parsed = &document;
+    if (document.m_is_evicted) {
+        auto path = document.filename();
+        if (!engine.rehydrate_document(path))
+            return nullptr;
+        parsed = get_document_data(path);
+        engine.mark_as_used(*parsed);
+    }
+    engine.ensure_symbols_are_declared(*parsed);
+    return parsed;
+}
+
+bool CppComprehensionEngine::rehydrate_document(std::string const& absolute_path)
+{
+    TRACE_SCOPE_WITH(span, "rehydrate_document");
+    TRACE_ARG(span, "file", absolute_path);
+    // We'll get here again through an #include cycle while the document is being parsed.
+    // Its summary stays in place until then, but it can't be used as a parsed document.
+    if (m_unfinished_documents.contains(absolute_path))
+        return false;
+
+    engine_statistics().increment(EngineCounter::Rehydrations);
+    bool are_todo_entries_published = get_document_data(absolute_path)->m_are_todo_entries_published;
+    auto document = create_document_data_for(absolute_path);
+    if (!document) {
+        // The file is gone, forget about it as if it was never parsed.
+        set_document_data(absolute_path, nullptr);
+        return false;
+    }
+
+    document->m_are_todo_entries_published = are_todo_entries_published;
+    set_document_data(absolute_path, move(document));
+    return true;
+}
+
+void CppComprehensionEngine::evict_document(std::string const& absolute_path)
+{
+    auto it = m_documents.find(absolute_path);
+    assert(it != m_documents.end());
+    auto const& document = *it->second;
+
+    auto summary = std::make_unique<DocumentData>();
+    summary->m_filename = document.m_filename;
+    summary->m_available_headers = document.m_available_headers;
+    summary->m_symbol_names = document.m_symbol_names;
+    summary->m_are_symbols_declared = document.m_are_symbols_declared;
+    summary->m_are_todo_entries_published = document.m_are_todo_entries_published;
+    summary->m_has_include_guard = document.m_has_include_guard;
+    summary->m_is_evicted = true;
+    summary->m_last_use = document.m_last_use;
+    summary->m_memory_usage = summary->compute_memory_usage();
+
+    // The memoized definitions of the document in m_included_headers are still valid, so documents that include it can be parsed without rehydrating it.
+    it->second = move(summary);
+    ++m_documents_generation;
+    engine_statistics().increment(EngineCounter::Evictions);
+}
+
+void CppComprehensionEngine::enforce_memory_budget(size_t in_use_since)
+{
+    if (m_memory_budget == 0)
+        return;
+
+    // Documents that were used after 'in_use_since' belong to the current request and have to stay.
+    // The definitions of included headers can't be evicted, but they count as well.
+    size_t total_usage = m_included_headers_memory_usage;
+    std::vector<DocumentData const*> candidates;
+    for (auto const& [path, document] : m_documents) {
+        total_usage += document->m_memory_usage;
+        if (!document->m_is_evicted && document->m_last_use <= in_use_since && !m_open_documents.contains(path))
+            candidates.push_back(document.get());
+    }
+    if (total_usage <= m_memory_budget)
+        return;
+
+    std::sort(candidates.begin(), candidates.end(), [](auto const* a, auto const* b) { return a->m_last_use < b->m_last_use; });
+
+    std::vector<std::string> evicted_paths;
+    for (auto const* document : candidates) {
+        if (total_usage <= m_memory_budget)
+            break;
+        total_usage -= document->m_memory_usage;
+        evicted_paths.push_back(document->filename());
+    }
+    if (evicted_paths.empty())
+        return;
+
+    for (auto const& path : evicted_paths) {
+        evict_document(path);
+        total_usage += get_document_data(path)->m_memory_usage;
+    }
+
+    // The query caches of the remaining documents may hold on to ASTs of evicted ones.
+    for (auto const& [path, document] : m_documents)
+        drop_stale_caches(*document);
+}
+
+std::vector<CodeComprehensionEngine::DocumentMemoryUsage> CppComprehensionEngine::memory_usage() const
+{
+    std::vector<DocumentMemoryUsage> usage;
+    usage.reserve(m_documents.size());
+    for (auto const& [path, document] : m_documents) {
+        auto bytes = document->m_memory_usage;
+        // The definitions of a header are memoized for its includers, see m_included_headers.
+        if (auto it = m_include_paths_of_headers.find(path); it != m_include_paths_of_headers.end()) {
+            for (auto const& include_path : it->second) {
+                if (auto header = m_included_headers.find(include_path); header != m_included_headers.end())
+                    bytes += header->second.memory_usage;
+            }
+        }
+        usage.push_back({ path, bytes, document->m_is_evicted });
+    }
+    return usage;
+}
+
+Statistics CppComprehensionEngine::statistics() const
+{
+    auto statistics = CodeComprehensionEngine::statistics();
+    statistics.documents.reserve(m_documents.size());
+    for (auto const& [path, document] : m_documents)
+        statistics.documents.push_back({ path, document->m_memory_usage, document->m_symbols.size(), document->m_is_evicted });
+    return statistics;
+}
+
+void CppComprehensionEngine::set_memory_budget(size_t bytes)
+{
+    m_memory_budget = bytes;
+    enforce_memory_budget(m_use_clock);
+}
+
+size_t CppComprehensionEngine::DocumentData::compute_memory_usage() const
+{
+    size_t usage = sizeof(DocumentData) + m_filename.capacity() + m_symbol_names.size_in_bytes();
+    for (auto const& header : m_available_headers)
+        usage += sizeof(std::string) + header.capacity();
+    if (m_is_evicted)
+        return usage;
+
+    usage += m_text.capacity();
+    // The preprocessor and the parser each keep their own tokens, and there's about one AST node per parsed token.
+    usage += preprocessor().unprocessed_tokens().size() * sizeof(Token);
+    usage += m_index.token_count() * (sizeof(Token) + sizeof(ASTNode));
+    usage += m_index.memory_usage() + m_substitution_index.memory_usage();
+
+    usage += m_symbols.size() * sizeof(decltype(m_symbols)::value_type);
+    // The scopes in m_symbol_arena, the member tables share one scope per struct or class.
+    for (auto const& [name, symbol] : m_symbols)
+        usage += name.scope.size() * sizeof(std::string_view);
+    for (auto const& bucket : m_symbols_by_kind)
+        usage += bucket.capacity() * sizeof(Symbol const*);
+    for (auto const& [declaration, members] : m_member_tables)
+        usage += members.capacity() * sizeof(Symbol);
+    for (auto const& [declaration, signature] : m_function_signatures) {
+        for (auto const& param : signature.params)
+            usage += sizeof(std::string) + param.capacity();
+    }
+    return usage;
 }
 
 std::optional<CodeComprehension::ProjectLocation> CppComprehensionEngine::find_declaration_of(std::string const& filename, const GUI::TextPosition& identifier_position)
 {
-    auto const* document_ptr = get_or_create_document_data(filename);
+    TRACE_SCOPE_WITH(span, "find_declaration_of");
+    TRACE_ARG(span, "file", filename);
+    auto timer = engine_statistics().time(EngineApi::FindDeclarationOf);
+    auto arena_scope = m_request_arena.scope();
+    auto const* document_ptr = get_or_create_indexed_document_data(filename);
     if (!document_ptr)
         return {};
 
@@ -440,9 +912,9 @@ std::optional<CodeComprehension::ProjectLocation> CppComprehensionEngine::find_d
     return find_preprocessor_definition(document, identifier_position);
 }
 
-intrusive_ptr<Cpp::Declaration const> CppComprehensionEngine::find_declaration_of(DocumentData const& document, const GUI::TextPosition& identifier_position)
+Cpp::Declaration const* CppComprehensionEngine::find_declaration_of(DocumentData const& document, const GUI::TextPosition& identifier_position)
 {
-    auto node = document.parser().node_at(Cpp::Position { identifier_position.line(), identifier_position.column() });
+    auto node = document.node_at(Cpp::Position { identifier_position.line(), identifier_position.column() });
     if (!node) {
         //dbgln("no node at position {}:{}", identifier_position.line(), identifier_position.column());
         return {};
@@ -453,23 +925,16 @@ intrusive_ptr<Cpp::Declaration const> CppComprehensionEngine::find_declaration_o
 std::optional<CodeComprehension::ProjectLocation> CppComprehensionEngine::find_preprocessor_definition(DocumentData const& document, const GUI::TextPosition& text_position)
 {
     Position cpp_position { text_position.line(), text_position.column() };
-    auto substitution = find_preprocessor_substitution(document, cpp_position);
-    if (!substitution.has_value())
+    auto const* substitution = find_preprocessor_substitution(document, cpp_position);
+    if (!substitution)
         return {};
     return CodeComprehension::ProjectLocation { substitution->defined_value.filename, substitution->defined_value.line, substitution->defined_value.column };
 }
 
-std::optional<Cpp::Preprocessor::Substitution> CppComprehensionEngine::find_preprocessor_substitution(DocumentData const& document, Cpp::Position const& cpp_position)
+Cpp::Preprocessor::Substitution const* CppComprehensionEngine::find_preprocessor_substitution(DocumentData const& document, Cpp::Position const& cpp_position) const
 {
     // Search for a replaced preprocessor token that intersects with text_position
-    for (auto& substitution : document.preprocessor().substitutions()) {
-        if (substitution.original_tokens.front().start() > cpp_position)
-            continue;
-        if (substitution.original_tokens.front().end() < cpp_position)
-            continue;
-        return substitution;
-    }
-    return {};
+    return document.m_substitution_index.find(cpp_position);
 }
 
 struct TargetDeclaration {
@@ -533,7 +998,7 @@ static std::optional<TargetDeclaration> get_target_declaration(ASTNode const& no
 
     return TargetDeclaration { TargetDeclaration::Type::Variable, name };
 }
-intrusive_ptr<Cpp::Declaration const> CppComprehensionEngine::find_declaration_of(DocumentData const& document_data, ASTNode const& node) const
+Cpp::Declaration const* CppComprehensionEngine::find_declaration_of(DocumentData const& document_data, ASTNode const& node) const
 {
     //dbgln("find_declaration_of: {} ({})", document_data.parser().text_of_node(node), node.class_name());
 
@@ -541,56 +1006,67 @@ intrusive_ptr<Cpp::Declaration const> CppComprehensionEngine::find_declaration_o
     if (!target_decl.has_value())
         return {};
 
+    // If we can infer the type of the object, look the property up in that type and its base classes.
+    if (target_decl->type == TargetDeclaration::Property && node.is_identifier() && is_property(node)) {
+        if (auto decl = find_declaration_of_property(document_data, static_cast<Identifier const&>(node)))
+            return decl;
+    }
+
     auto reference_scope = scope_of_reference_to_symbol(node);
     auto current_scope = scope_of_node(node);
 
     auto symbol_matches = [&](Symbol const& symbol) {
-        bool match_function = target_decl.value().type == TargetDeclaration::Function && symbol.declaration->is_function();
-        bool match_variable = target_decl.value().type == TargetDeclaration::Variable && symbol.declaration->is_variable_declaration();
-        bool match_type = target_decl.value().type == TargetDeclaration::Type && (symbol.declaration->is_struct_or_class() || symbol.declaration->is_enum());
-        bool match_property = target_decl.value().type == TargetDeclaration::Property && symbol.declaration->parent()->is_declaration() && assert_cast<Cpp::Declaration>(symbol.declaration->parent())->is_struct_or_class();
-        bool match_parameter = target_decl.value().type == TargetDeclaration::Variable && symbol.declaration->is_parameter();
-        bool match_scope = target_decl.value().type == TargetDeclaration::Scope && (symbol.declaration->is_namespace() || symbol.declaration->is_struct_or_class());
-
-        if (match_property) {
+        if (symbol.name.name != target_decl->name)
+            return false;
+
+        if (target_decl->type == TargetDeclaration::Property) {
             // FIXME: This is not really correct, we also need to check that the type of the struct/class matches (not just the property name)
-            if (symbol.name.name == target_decl.value().name) {
-                return true;
-            }
+            return true;
         }
 
         if (!is_symbol_available(symbol, current_scope, reference_scope)) {
             return false;
         }
 
-        if (match_function || match_type || match_scope) {
-            if (symbol.name.name == target_decl->name)
-                return true;
-        }
-
-        if (match_variable || match_parameter) {
+        if (target_decl->type == TargetDeclaration::Variable) {
             // If this symbol was declared below us in a function, it's not available to us.
             bool is_unavailable = symbol.is_local && symbol.declaration->start().line > node.start().line;
-
-            if (!is_unavailable && (symbol.name.name == target_decl->name)) {
-                return true;
-            }
+            return !is_unavailable;
         }
 
-        return false;
+        return true;
     };
 
-    std::optional<Symbol> match;
+    SymbolKind kind = SymbolKind::Variable;
+    switch (target_decl->type) {
+    case TargetDeclaration::Function:
+        kind = SymbolKind::Function;
+        break;
+    case TargetDeclaration::Type:
+        kind = SymbolKind::Type;
+        break;
+    case TargetDeclaration::Variable:
+        kind = SymbolKind::Variable;
+        break;
+    case TargetDeclaration::Property:
+        kind = SymbolKind::Member;
+        break;
+    case TargetDeclaration::Scope:
+        kind = SymbolKind::Scope;
+        break;
+    }
+
+    Symbol const* match = nullptr;
 
-    for_each_available_symbol(document_data, [&](Symbol const& symbol) {
+    for_each_available_symbol_of_kind(document_data, kind, target_decl->name, [&](Symbol const& symbol) {
         if (symbol_matches(symbol)) {
-            match = symbol;
+            match = &symbol;
             return IterationDecision::Break;
         }
         return IterationDecision::Continue;
     });
 
-    if (!match.has_value())
+    if (!match)
         return {};
 
     return match->declaration;
@@ -598,24 +1074,94 @@ intrusive_ptr<Cpp::Declaration const> CppComprehensionEngine::find_declaration_o
 
 void CppComprehensionEngine::update_declared_symbols(DocumentData& document)
 {
-    for (auto& symbol : get_child_symbols(*document.parser().root_node())) {
-        document.m_symbols.emplace(symbol.name, std::move(symbol));
+    TRACE_SCOPE_WITH(span, "update_declared_symbols");
+    TRACE_ARG(span, "file", document.filename());
+    auto symbols = get_child_symbols(*document.parser().root_node(), document.m_symbol_arena);
+    update_function_signatures(document, symbols);
+
+    for (auto& symbol : symbols) {
+        if (symbol.declaration->is_struct_or_class()) {
+            auto& struct_or_class = assert_cast<StructOrClassDeclaration>(*symbol.declaration);
+            std::vector<std::string_view> scope(symbol.name.scope.begin(), symbol.name.scope.end());
+            scope.push_back(symbol.name.name);
+            // Shared by all members, its parts are already split.
+            auto members_scope = SymbolName::copy_scope(scope, document.m_symbol_arena);
+
+            std::vector<Symbol> members;
+            members.reserve(struct_or_class.members().size());
+            for (auto& member : struct_or_class.members())
+                members.push_back({ { member->full_name(), members_scope }, &*member, false });
+            document.m_member_tables.emplace(symbol.declaration, move(members));
+        }
+        document.m_symbols.emplace(symbol.name, symbol);
+    }
+
+    document.m_symbol_names = BloomFilter(document.m_symbols.size());
+    for (auto& symbol_entry : document.m_symbols) {
+        auto const& symbol = symbol_entry.second;
+        auto const& decl = *symbol.declaration;
+        document.m_symbol_names.add(symbol.name.name);
+        auto add_to_bucket = [&](SymbolKind kind) { document.m_symbols_by_kind[static_cast<size_t>(kind)].push_back(&symbol); };
+
+        if (decl.is_function())
+            add_to_bucket(SymbolKind::Function);
+        if (decl.is_struct_or_class() || decl.is_enum())
+            add_to_bucket(SymbolKind::Type);
+        if (decl.is_variable_declaration() || decl.is_parameter())
+            add_to_bucket(SymbolKind::Variable);
+        if (decl.parent() && decl.parent()->is_declaration() && assert_cast<Cpp::Declaration>(decl.parent())->is_struct_or_class())
+            add_to_bucket(SymbolKind::Member);
+        if (decl.is_namespace() || decl.is_struct_or_class())
+            add_to_bucket(SymbolKind::Scope);
     }
 
     std::vector<CodeComprehension::Declaration> declarations;
     for (auto& symbol_entry : document.m_symbols) {
         auto& symbol = symbol_entry.second;
-        declarations.push_back({ std::string{symbol.name.name}, { document.filename(), symbol.declaration->start().line, symbol.declaration->start().column }, type_of_declaration(*symbol.declaration.get()), symbol.name.scope_as_string() });
+        declarations.push_back({ std::string{symbol.name.name}, { document.filename(), symbol.declaration->start().line, symbol.declaration->start().column }, type_of_declaration(*symbol.declaration), symbol.name.scope_as_string() });
     }
 
     for (auto& definition : document.preprocessor().definitions()) {
         declarations.push_back({ definition.first, { document.filename(), definition.second.line, definition.second.column }, CodeComprehension::DeclarationType::PreprocessorDefinition, {} });
     }
+    TRACE_ARG(span, "symbols", document.m_symbols.size());
+
+    TRACE_SCOPE_WITH(publish_span, "set_declarations_of_document");
+    TRACE_ARG(publish_span, "declarations", declarations.size());
     set_declarations_of_document(document.filename(), move(declarations));
 }
 
+void CppComprehensionEngine::update_function_signatures(DocumentData& document, std::vector<Symbol> const& symbols)
+{
+    std::unordered_map<SymbolName, size_t, KeySymbolHash> overloads_indices;
+    for (auto& symbol : symbols) {
+        if (!symbol.declaration->is_function())
+            continue;
+        auto& func_decl = assert_cast<FunctionDeclaration>(*symbol.declaration);
+
+        FunctionSignature signature;
+        for (auto& arg : func_decl.parameters()) {
+            std::vector<std::string_view> tokens_text;
+            for (auto token : document.parser().tokens_in_range(arg->start(), arg->end())) {
+                tokens_text.push_back(token.text());
+            }
+            signature.params.push_back(join_strings(' ', tokens_text));
+        }
+
+        auto [overloads, is_new] = overloads_indices.emplace(symbol.name, document.m_function_overloads.size());
+        if (is_new)
+            document.m_function_overloads.emplace_back();
+        document.m_function_overloads[overloads->second].push_back(symbol.declaration);
+        signature.overloads_index = overloads->second;
+
+        document.m_function_signatures.emplace(symbol.declaration, move(signature));
+    }
+}
+
 void CppComprehensionEngine::update_todo_entries(DocumentData& document)
 {
+    TRACE_SCOPE_WITH(span, "update_todo_entries");
+    TRACE_ARG(span, "file", document.filename());
     set_todo_entries_of_document(document.filename(), document.parser().get_todo_entries());
 }
 
@@ -638,6 +1184,12 @@ CodeComprehension::DeclarationType CppComprehensionEngine::type_of_declaration(C
 
 std::unique_ptr<CppComprehensionEngine::DocumentData> CppComprehensionEngine::create_document_data(std::string text, std::string const& filename)
 {
+    TRACE_SCOPE_WITH(span, "create_document_data");
+    TRACE_ARG(span, "file", filename);
+    TRACE_ARG(span, "bytes", text.size());
+
+    engine_statistics().increment(EngineCounter::Parses);
+
     auto document_data = std::make_unique<DocumentData>();
     document_data->m_filename = filename;
     document_data->m_text = move(text);
@@ -646,74 +1198,180 @@ std::unique_ptr<CppComprehensionEngine::DocumentData> CppComprehensionEngine::cr
     document_data->preprocessor().set_ignore_invalid_statements(true);
     document_data->preprocessor().set_keep_include_statements(true);
 
-    document_data->preprocessor().definitions_in_header_callback = [this](std::string_view include_path) -> Preprocessor::Definitions {
-        auto included_document = get_or_create_document_data(document_path_from_include_path(include_path));
-        if (!included_document)
+    // Headers whose definitions were already merged into this document, directly or through another header.
+    std::unordered_set<std::string> merged_headers;
+
+    document_data->preprocessor().definitions_in_header_callback = [this, &merged_headers](std::string_view include_path) -> Preprocessor::Definitions {
+        TRACE_SCOPE_WITH(include_span, "resolve include");
+        TRACE_ARG(include_span, "include", std::string { include_path });
+        auto const* included_header = get_or_create_included_header(include_path);
+        if (!included_header)
+            return {};
+
+        // Including a guarded header for the second time is a no-op.
+        if (included_header->has_include_guard && merged_headers.contains(included_header->path))
             return {};
 
-        return included_document->preprocessor().definitions();
+        merged_headers.emplace(included_header->path);
+        if (auto const* included_document = get_document_data(included_header->path)) {
+            for (auto& header : included_document->m_available_headers) {
+                if (auto const* document = get_document_data(header); document && document->m_has_include_guard)
+                    merged_headers.emplace(header);
+            }
+        }
+        return *included_header->definitions;
     };
 
-    auto tokens = document_data->preprocessor().process_and_lex();
+    std::vector<Token> tokens;
+    {
+        TRACE_SCOPE_WITH(lex_span, "process_and_lex");
+        tokens = document_data->preprocessor().process_and_lex();
+        TRACE_ARG(lex_span, "tokens", tokens.size());
+    }
+    document_data->preprocessor().definitions_in_header_callback = nullptr;
+    document_data->m_substitution_index.build(document_data->preprocessor());
+    document_data->m_has_include_guard = has_include_guard(*document_data);
 
-    for (auto include_path : document_data->preprocessor().included_paths()) {
-        auto include_fullpath = document_path_from_include_path(include_path);
-        auto included_document = get_or_create_document_data(include_fullpath);
-        if (!included_document)
-            continue;
+    {
+        TRACE_SCOPE_WITH(includes_span, "collect available headers");
+        for (auto include_path : document_data->preprocessor().included_paths()) {
+            auto const* included_header = get_or_create_included_header(include_path);
+            if (!included_header)
+                continue;
+
+            // A guarded header we've already seen was merged together with all of its own headers.
+            if (included_header->has_include_guard && document_data->m_available_headers.contains(included_header->path))
+                continue;
 
-        document_data->m_available_headers.emplace(include_fullpath);
+            auto const* included_document = get_document_data(included_header->path);
+            if (!included_document)
+                continue;
 
-        for (auto& header : included_document->m_available_headers)
-            document_data->m_available_headers.emplace(header);
+            document_data->m_available_headers.emplace(included_header->path);
+
+            for (auto& header : included_document->m_available_headers)
+                document_data->m_available_headers.emplace(header);
+        }
+        TRACE_ARG(includes_span, "headers", document_data->m_available_headers.size());
     }
 
+    {
+        TRACE_SCOPE("build document index");
+        document_data->m_index.build(document_data->text(), tokens);
+    }
     document_data->m_parser = std::make_unique<Parser>(move(tokens), filename);
 
-    auto root = document_data->parser().parse();
-
-    if constexpr (CPP_LANGUAGE_SERVER_DEBUG)
-        root->dump();
+    {
+        TRACE_SCOPE("parse");
+        auto root = document_data->parser().parse();
 
-    update_declared_symbols(*document_data);
-    update_todo_entries(*document_data);
+        if constexpr (CPP_LANGUAGE_SERVER_DEBUG)
+            root->dump();
+    }
 
+    // Building the symbol table and extracting TODOs is deferred until a query or the host needs them,
+    // most of the headers we parse are never searched.
+    document_data->m_memory_usage = document_data->compute_memory_usage();
     return document_data;
 }
 
-std::vector<std::string_view> CppComprehensionEngine::scope_of_node(ASTNode const& node) const
+bool CppComprehensionEngine::has_include_guard(DocumentData const& document)
 {
+    auto split_directive = [](std::string_view statement) {
+        auto skip_whitespace = [&] {
+            while (!statement.empty() && (statement.front() == ' ' || statement.front() == '\t'))
+                statement.remove_prefix(1);
+        };
+        auto take_word = [&] {
+            skip_whitespace();
+            size_t length = 0;
+            while (length < statement.length() && (isalnum(static_cast<unsigned char>(statement[length])) || statement[length] == '_'))
+                ++length;
+            auto word = statement.substr(0, length);
+            statement.remove_prefix(length);
+            return word;
+        };
+
+        assert(statement.starts_with('#'));
+        statement.remove_prefix(1);
+        auto keyword = take_word();
+        auto argument = take_word();
+        return std::pair { keyword, argument };
+    };
 
-    auto parent = node.parent();
-    if (!parent)
-        return {};
+    std::vector<Token const*> statements;
+    Token const* last_significant_token = nullptr;
+    for (auto const& token : document.preprocessor().unprocessed_tokens()) {
+        if (token.type() == Token::Type::Whitespace || token.type() == Token::Type::Comment)
+            continue;
+        // Code before the first statement can't be inside of a guard.
+        if (!last_significant_token && token.type() != Token::Type::PreprocessorStatement)
+            return false;
+        last_significant_token = &token;
+        if (token.type() == Token::Type::PreprocessorStatement)
+            statements.push_back(&token);
+    }
 
-    auto parent_scope = scope_of_node(*parent);
-
-    if (!parent->is_declaration())
-        return parent_scope;
-
-    auto& parent_decl = static_cast<Cpp::Declaration const&>(*parent);
-
-    std::string_view containing_scope;
-    if (parent_decl.is_namespace())
-        containing_scope = static_cast<NamespaceDeclaration const&>(parent_decl).full_name();
-    if (parent_decl.is_struct_or_class())
-        containing_scope = static_cast<StructOrClassDeclaration const&>(parent_decl).full_name();
-    if (parent_decl.is_function()) {
-        containing_scope = static_cast<FunctionDeclaration const &>(parent_decl).full_name();
-        size_t start = 0;
-        size_t end = containing_scope.find("::");
-        while (end != std::string::npos) {
-            parent_scope.push_back(containing_scope.substr(start, end - start));
-            start = end + strlen("::");
-            end = containing_scope.find("::", start);
-        }
-        containing_scope = containing_scope.substr(start, end - start);
+    if (statements.empty())
+        return false;
+
+    auto [first_keyword, first_argument] = split_directive(statements.front()->text());
+    if (first_keyword == "pragma" && first_argument == "once")
+        return true;
+
+    if (first_keyword != "ifndef" || statements.size() < 3 || last_significant_token != statements.back())
+        return false;
+
+    auto [second_keyword, second_argument] = split_directive(statements[1]->text());
+    if (second_keyword != "define" || second_argument != first_argument)
+        return false;
+
+    // The #endif that closes the guard has to be the last statement in the file.
+    size_t depth = 0;
+    for (size_t i = 0; i < statements.size(); ++i) {
+        auto keyword = split_directive(statements[i]->text()).first;
+        if (keyword == "if" || keyword == "ifdef" || keyword == "ifndef")
+            ++depth;
+        else if (keyword == "endif" && depth > 0 && --depth == 0)
+            return i == statements.size() - 1;
+    }
+    return false;
+}
+
+CppComprehensionEngine::ScopeParts CppComprehensionEngine::scope_of_node(ASTNode const& node) const
+{
+    // Every declaration that encloses the node contributes to its scope, the outermost one first.
+    std::pmr::vector<Cpp::Declaration const*> enclosing_declarations(&m_request_arena);
+    for (auto const* parent = node.parent(); parent; parent = parent->parent()) {
+        if (parent->is_declaration())
+            enclosing_declarations.push_back(static_cast<Cpp::Declaration const*>(parent));
     }
 
-    parent_scope.push_back(containing_scope);
-    return parent_scope;
+    ScopeParts scope(&m_request_arena);
+    scope.reserve(enclosing_declarations.size());
+    for (auto it = enclosing_declarations.rbegin(); it != enclosing_declarations.rend(); ++it) {
+        auto& parent_decl = **it;
+
+        std::string_view containing_scope;
+        if (parent_decl.is_namespace())
+            containing_scope = static_cast<NamespaceDeclaration const&>(parent_decl).full_name();
+        if (parent_decl.is_struct_or_class())
+            containing_scope = static_cast<StructOrClassDeclaration const&>(parent_decl).full_name();
+        if (parent_decl.is_function()) {
+            containing_scope = static_cast<FunctionDeclaration const &>(parent_decl).full_name();
+            size_t start = 0;
+            size_t end = containing_scope.find("::");
+            while (end != std::string::npos) {
+                scope.push_back(containing_scope.substr(start, end - start));
+                start = end + strlen("::");
+                end = containing_scope.find("::", start);
+            }
+            containing_scope = containing_scope.substr(start, end - start);
+        }
+
+        scope.push_back(containing_scope);
+    }
+    return scope;
 }
 
 // trim from both ends (in place)
@@ -798,66 +1456,36 @@ std::optional<std::vector<CodeComprehension::AutocompleteResultEntry>> CppCompre
     return options;
 }
 
-intrusive_ptr<Cpp::Declaration const> CppComprehensionEngine::find_declaration_of(CppComprehensionEngine::DocumentData const& document, CppComprehensionEngine::SymbolName const& target_symbol_name) const
+Cpp::Declaration const* CppComprehensionEngine::find_declaration_of(CppComprehensionEngine::DocumentData const& document, SymbolName const& target_symbol_name) const
 {
-    intrusive_ptr<Cpp::Declaration const> target_declaration;
-    for_each_available_symbol(document, [&](Symbol const& symbol) {
-        if (symbol.name == target_symbol_name) {
-            target_declaration = symbol.declaration;
-            return IterationDecision::Break;
-        }
-        return IterationDecision::Continue;
-    });
-    return target_declaration;
-}
-
-std::string CppComprehensionEngine::SymbolName::scope_as_string() const
-{
-    if (scope.empty())
-        return "";
-
-    std::string builder;
-    for (size_t i = 0; i < scope.size() - 1; ++i) {
-        builder.append(fmt::format("{}::", scope[i]));
-    }
-    builder.append(scope.back());
-    return builder;
-}
-
-CppComprehensionEngine::SymbolName CppComprehensionEngine::SymbolName::create(std::string_view name, std::vector<std::string_view>&& scope)
-{
-    std::vector<std::string_view> resultant_scope_vector;
-
-    for(auto const& scope_entry : scope) {
-        auto parts = split_view(scope_entry, "::");
-        for(auto const& part : parts)
-            resultant_scope_vector.push_back(part);
-    }
-
-    return CppComprehensionEngine::SymbolName{ name, move(resultant_scope_vector) };
-}
-
+    auto find_in_document = [&](DocumentData const& document) -> Cpp::Declaration const* {
+        if (!document.m_symbol_names.may_contain(target_symbol_name.name))
+            return {};
+        auto symbol = document.m_symbols.find(target_symbol_name);
+        if (symbol == document.m_symbols.end())
+            return {};
+        return symbol->second.declaration;
+    };
 
-CppComprehensionEngine::SymbolName CppComprehensionEngine::SymbolName::create(std::string_view qualified_name)
-{
-    auto parts = split_view(qualified_name, "::");
-    assert(!parts.empty());
-    auto name = parts.back(); parts.pop_back();
-    return SymbolName::create(name, move(parts));
-}
+    auto target_declaration = find_in_document(document);
+    if (target_declaration)
+        return target_declaration;
 
-std::string CppComprehensionEngine::SymbolName::to_byte_string() const
-{
-    if (scope.empty())
-        return std::string{name};
-    return fmt::format("{}::{}", scope_as_string(), name);
+    for_each_included_document_recursive(document, [&](DocumentData const& included_document) {
+        if (!may_declare(included_document, target_symbol_name.name))
+            return IterationDecision::Continue;
+        if (auto const* parsed = parsed_document(included_document))
+            target_declaration = find_in_document(*parsed);
+        return target_declaration ? IterationDecision::Break : IterationDecision::Continue;
+    });
+    return target_declaration;
 }
 
-bool CppComprehensionEngine::is_symbol_available(Symbol const& symbol, std::vector<std::string_view> const& current_scope, std::vector<std::string_view> const& reference_scope)
+bool CppComprehensionEngine::is_symbol_available(Symbol const& symbol, std::span<std::string_view const> current_scope, std::span<std::string_view const> reference_scope)
 {
 
     if (!reference_scope.empty()) {
-        return reference_scope == symbol.name.scope;
+        return std::equal(reference_scope.begin(), reference_scope.end(), symbol.name.scope.begin(), symbol.name.scope.end());
     }
 
     // FIXME: Take "using namespace ..." into consideration
@@ -876,13 +1504,17 @@ bool CppComprehensionEngine::is_symbol_available(Symbol const& symbol, std::vect
 
 std::optional<CodeComprehensionEngine::FunctionParamsHint> CppComprehensionEngine::get_function_params_hint(std::string const& filename, const GUI::TextPosition& identifier_position)
 {
-    auto const* document_ptr = get_or_create_document_data(filename);
+    TRACE_SCOPE_WITH(span, "get_function_params_hint");
+    TRACE_ARG(span, "file", filename);
+    auto timer = engine_statistics().time(EngineApi::GetFunctionParamsHint);
+    auto arena_scope = m_request_arena.scope();
+    auto const* document_ptr = get_or_create_indexed_document_data(filename);
     if (!document_ptr)
         return {};
 
     auto const& document = *document_ptr;
     Cpp::Position cpp_position { identifier_position.line(), identifier_position.column() };
-    auto node = document.parser().node_at(cpp_position);
+    auto node = document.node_at(cpp_position);
     if (!node) {
 //        dbgln("no node at position {}:{}", identifier_position.line(), identifier_position.column());
         return {};
@@ -895,7 +1527,7 @@ std::optional<CodeComprehensionEngine::FunctionParamsHint> CppComprehensionEngin
     if (node->is_function_call()) {
         call_node = assert_cast<FunctionCall>(node.get());
 
-        auto token = document.parser().token_at(cpp_position);
+        auto token = document.token_at(cpp_position);
 
         // If we're in a function call with 0 arguments
         if (token.has_value() && (token->type() == Token::Type::LeftParen || token->type() == Token::Type::RightParen)) {
@@ -969,17 +1601,22 @@ std::optional<CppComprehensionEngine::FunctionParamsHint> CppComprehensionEngine
         return {};
     }
 
-    auto& func_decl = assert_cast<FunctionDeclaration>(*decl);
-    auto document_of_declaration = get_document_data(func_decl.filename());
+    auto const* declaring_document = document_of_declaration(*decl);
+    if (!declaring_document)
+        return {};
+
+    auto signature = declaring_document->m_function_signatures.find(decl);
+    if (signature == declaring_document->m_function_signatures.end())
+        return {};
 
     FunctionParamsHint hint {};
     hint.current_index = argument_index;
-    for (auto& arg : func_decl.parameters()) {
-        std::vector<std::string_view> tokens_text;
-        for (auto token : document_of_declaration->parser().tokens_in_range(arg->start(), arg->end())) {
-            tokens_text.push_back(token.text());
-        }
-        hint.params.push_back(join_strings(' ', tokens_text));
+    hint.params = signature->second.params;
+    for (auto const* overload : declaring_document->m_function_overloads[signature->second.overloads_index]) {
+        auto& params = declaring_document->m_function_signatures.at(overload).params;
+        // A function that is declared and then defined in the same document shows up twice.
+        if (std::find(hint.overloads.begin(), hint.overloads.end(), params) == hint.overloads.end())
+            hint.overloads.push_back(params);
     }
 
     return hint;
@@ -987,16 +1624,23 @@ std::optional<CppComprehensionEngine::FunctionParamsHint> CppComprehensionEngine
 
 std::vector<CodeComprehension::TokenInfo> CppComprehensionEngine::get_tokens_info(std::string const& filename)
 {
+    TRACE_SCOPE_WITH(span, "get_tokens_info");
+    TRACE_ARG(span, "file", filename);
+    auto timer = engine_statistics().time(EngineApi::GetTokensInfo);
+    auto arena_scope = m_request_arena.scope();
 //    dbgln("CppComprehensionEngine::get_tokens_info: {}", filename);
 
-    auto const* document_ptr = get_or_create_document_data(filename);
+    auto const* document_ptr = get_or_create_indexed_document_data(filename);
     if (!document_ptr)
         return {};
 
     auto const& document = *document_ptr;
 
     std::vector<CodeComprehension::TokenInfo> tokens_info;
+    tokens_info.reserve(document.preprocessor().unprocessed_tokens().size());
     for (auto const& token : document.preprocessor().unprocessed_tokens()) {
+        // Every identifier is looked up on its own, their temporaries don't need to pile up.
+        auto token_scope = m_request_arena.scope();
 
         tokens_info.push_back({ get_token_semantic_type(document, token),
                              token.start().line, token.start().column, token.end().line, token.end().column });
@@ -1038,7 +1682,7 @@ CodeComprehension::TokenInfo::SemanticType CppComprehensionEngine::get_token_sem
 
 CodeComprehension::TokenInfo::SemanticType CppComprehensionEngine::get_semantic_type_for_identifier(DocumentData const& document, Position position)
 {
-    if (find_preprocessor_substitution(document, position).has_value())
+    if (find_preprocessor_substitution(document, position))
         return CodeComprehension::TokenInfo::SemanticType::PreprocessorMacro;
 
     auto decl = find_declaration_of(document, GUI::TextPosition { position.line, position.column });
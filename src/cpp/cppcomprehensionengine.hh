@@ -6,18 +6,29 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <functional>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
 #include <vector>
 #include <unordered_set>
 #include <memory>
 
+#include "../bloomfilter.hh"
 #include "../filedb.hh"
+#include "../flathashmap.hh"
+#include "../requestarena.hh"
 #include "cpp_parser/ast.hh"
 #include "cpp_parser/parser.hh"
 #include "cpp_parser/preprocessor.hh"
 #include "cpp_parser/intrusive_ptr.hh"
 #include "../codecomprehensionengine.hh"
+#include "documentindex.hh"
+#include "substitutionindex.hh"
+#include "symbolname.hh"
 
 namespace CodeComprehension::Cpp {
 
@@ -33,64 +44,18 @@ public:
     virtual std::optional<CodeComprehension::ProjectLocation> find_declaration_of(std::string const& filename, GUI::TextPosition const& identifier_position) override;
     virtual std::optional<FunctionParamsHint> get_function_params_hint(std::string const&, GUI::TextPosition const&) override;
     virtual std::vector<CodeComprehension::TokenInfo> get_tokens_info(std::string const& filename) override;
+    virtual std::shared_ptr<DocumentOutline const> document_outline(std::string const& filename) override;
+    virtual void index_document(std::string const& filename) override;
+    virtual void file_closed(std::string const& filename) override;
+    virtual std::vector<DocumentMemoryUsage> memory_usage() const override;
+    virtual void set_memory_budget(size_t bytes) override;
+    virtual Statistics statistics() const override;
 
 private:
-    struct SymbolName {
-        std::string_view name;
-        std::vector<std::string_view> scope;
-
-        static SymbolName create(std::string_view, std::vector<std::string_view>&&);
-        static SymbolName create(std::string_view);
-        std::string scope_as_string() const;
-        std::string to_byte_string() const;
-
-        bool operator==(SymbolName const&) const = default;
-    };
-
-    static constexpr unsigned int_hash(uint32_t key)
-    {
-        key += ~(key << 15);
-        key ^= (key >> 10);
-        key += (key << 3);
-        key ^= (key >> 6);
-        key += ~(key << 11);
-        key ^= (key >> 16);
-        return key;
-    }
-
-    static constexpr unsigned pair_int_hash(uint32_t key1, uint32_t key2)
-    {
-        return int_hash((int_hash(key1) * 209) ^ (int_hash(key2 * 413)));
-    }
-
-    static constexpr uint32_t string_hash(char const* characters, size_t length, uint32_t seed = 0)
-    {
-        uint32_t hash = seed;
-        for (size_t i = 0; i < length; ++i) {
-            hash += static_cast<uint32_t>(characters[i]);
-            hash += (hash << 10);
-            hash ^= (hash >> 6);
-        }
-        hash += hash << 3;
-        hash ^= hash >> 11;
-        hash += hash << 15;
-        return hash;
-    }
-
-    class KeySymbolHash {
-    public:
-        size_t operator()(CodeComprehension::Cpp::CppComprehensionEngine::SymbolName const& key) const {
-            unsigned hash = 0;
-            hash = pair_int_hash(hash, string_hash(key.name.data(), key.name.length()));
-            for (auto& scope_part : key.scope) {
-                hash = pair_int_hash(hash, string_hash(scope_part.data(), scope_part.length()));
-            }
-            return hash;
-        }
-    };
     struct Symbol {
         SymbolName name;
-        intrusive_ptr<Cpp::Declaration const> declaration;
+        // Owned by the AST of the declaring document, so it lives as long as that DocumentData does.
+        Cpp::Declaration const* declaration { nullptr };
 
         // Local symbols are symbols that should not appear in a global symbol search.
         // For example, a variable that is declared inside a function will have is_local = true.
@@ -100,11 +65,34 @@ private:
             No,
             Yes
         };
-        static Symbol create(std::string_view name, std::vector<std::string_view> const& scope, intrusive_ptr<Cpp::Declaration const>, IsLocal is_local);
+        static Symbol create(std::string_view name, std::span<std::string_view const> scope, Cpp::Declaration const&, IsLocal is_local, std::pmr::memory_resource&);
     };
+    // Symbols are copied into query results and member tables a lot, they should stay cheap to copy.
+    static_assert(std::is_trivially_copyable_v<Symbol>);
 
     //friend Traits<SymbolName>;
 
+    // The kinds of declarations that name lookups search for. A symbol can be of more than one kind,
+    // e.g a struct is both a Type and a Scope, and a data member is both a Variable and a Member.
+    enum class SymbolKind {
+        Function,
+        Type,
+        // Variables and parameters
+        Variable,
+        // Declarations inside of a struct or class
+        Member,
+        // Namespaces, structs and classes
+        Scope,
+    };
+    static constexpr size_t symbol_kind_count = static_cast<size_t>(SymbolKind::Scope) + 1;
+
+    struct FunctionSignature {
+        // The text of each parameter, e.g "int x".
+        std::vector<std::string> params;
+        // Index into DocumentData::m_function_overloads.
+        size_t overloads_index { 0 };
+    };
+
     struct DocumentData {
         std::string const& filename() const { return m_filename; }
         std::string const& text() const { return m_text; }
@@ -128,72 +116,187 @@ private:
             assert(m_parser);
             return *m_parser;
         }
+        DocumentIndex::NodePtr node_at(Position const& position) const { return m_index.node_at(parser(), position); }
+        std::optional<Token> token_at(Position const& position) const { return m_index.token_at(parser(), position); }
+        // An estimate that doesn't include the query caches, see m_memory_usage.
+        size_t compute_memory_usage() const;
 
         std::string m_filename;
         std::string m_text;
         std::unique_ptr<Preprocessor> m_preprocessor;
         std::unique_ptr<Parser> m_parser;
 
-        std::unordered_map<SymbolName, Symbol, KeySymbolHash> m_symbols;
+        // Backs the scopes of the symbol names in m_symbols and m_member_tables, which are all freed at once with the document.
+        std::pmr::monotonic_buffer_resource m_symbol_arena;
+        FlatHashMap<SymbolName, Symbol, KeySymbolHash> m_symbols;
+        // The entries of m_symbols partitioned by SymbolKind, in the same order.
+        std::array<std::vector<Symbol const*>, symbol_kind_count> m_symbols_by_kind;
+        // The names of all entries in m_symbols, lets name lookups skip documents that can't declare the name.
+        BloomFilter m_symbol_names;
         std::unordered_set<std::string> m_available_headers;
+        SubstitutionIndex m_substitution_index;
+        DocumentIndex m_index;
+
+        // The members of every struct or class declared in this document, built in update_declared_symbols().
+        std::unordered_map<Cpp::Declaration const*, std::vector<Symbol>> m_member_tables;
+        // Signatures of every function declared in this document, built in update_declared_symbols().
+        std::unordered_map<Cpp::Declaration const*, FunctionSignature> m_function_signatures;
+        // Groups of functions that share a name and scope. Only one of them makes it into m_symbols.
+        std::vector<std::vector<Cpp::Declaration const*>> m_function_overloads;
+
+        // Built on the first request, a re-parse creates a new DocumentData.
+        mutable std::shared_ptr<DocumentOutline const> m_outline;
+
+        // Query caches. They are dropped whenever one of our headers is re-parsed, see m_documents_generation.
+        mutable size_t m_caches_generation { 0 };
+        mutable std::unordered_map<std::string, Cpp::Declaration const*> m_declarations_of_types;
+        // Members of a struct or class including the ones it inherits, see members_of().
+        mutable std::unordered_map<Cpp::Declaration const*, std::vector<Symbol>> m_flattened_member_tables;
+        // Type names of expressions in this document, see type_of().
+        mutable std::unordered_map<Expression const*, std::string> m_types_of_expressions;
+
+        // The symbol table and everything derived from it are built on demand, see ensure_symbols_are_declared().
+        bool m_are_symbols_declared { false };
+        bool m_are_todo_entries_published { false };
+
+        // True if the whole document is wrapped in an include guard or starts with "#pragma once",
+        // i.e including it more than once in a translation unit has no effect.
+        bool m_has_include_guard { false };
+
+        // An evicted document only has its filename, its available headers, m_symbol_names and the flags above.
+        // Name lookups only parse it again if it may declare the name, see may_declare() and parsed_document().
+        // The declarations we've published for it stay in the workspace symbol index.
+        bool m_is_evicted { false };
+        // Updated whenever the document is created or its symbol table is built.
+        size_t m_memory_usage { 0 };
+        // The value of m_use_clock when the document was last used by a request.
+        mutable size_t m_last_use { 0 };
+    };
+
+    // The result of resolving an #include path and preprocessing the header it refers to.
+    // Headers are preprocessed standalone, so the included path alone identifies the result.
+    struct IncludedHeader {
+        std::string path;
+        // Shared by every includer of the header, so that it is only snapshotted once per parse of the header.
+        std::shared_ptr<Preprocessor::Definitions const> definitions;
+        bool has_include_guard { false };
+        // An estimate of the size of the definitions, they stay when the header is evicted.
+        size_t memory_usage { 0 };
     };
 
     std::vector<CodeComprehension::AutocompleteResultEntry> autocomplete_property(DocumentData const&, MemberExpression const&, const std::string partial_text) const;
     std::vector<AutocompleteResultEntry> autocomplete_name(DocumentData const&, ASTNode const&, std::string const& partial_text) const;
+    // Returns a copy, the cache it comes from is dropped by drop_stale_caches() which further lookups may call.
     std::string type_of(DocumentData const&, Expression const&) const;
+    std::string compute_type_of(DocumentData const&, Expression const&) const;
     std::string type_of_property(DocumentData const&, Identifier const&) const;
     std::string type_of_variable(Identifier const&) const;
     bool is_property(ASTNode const&) const;
-    intrusive_ptr<Cpp::Declaration const> find_declaration_of(DocumentData const&, ASTNode const&) const;
-    intrusive_ptr<Cpp::Declaration const> find_declaration_of(DocumentData const&, SymbolName const&) const;
-    intrusive_ptr<Cpp::Declaration const> find_declaration_of(DocumentData const&, const GUI::TextPosition& identifier_position);
+    Cpp::Declaration const* find_declaration_of(DocumentData const&, ASTNode const&) const;
+    Cpp::Declaration const* find_declaration_of(DocumentData const&, SymbolName const&) const;
+    Cpp::Declaration const* find_declaration_of(DocumentData const&, const GUI::TextPosition& identifier_position);
 
     enum class RecurseIntoScopes {
         No,
         Yes
     };
 
-    std::vector<Symbol> properties_of_type(DocumentData const& document, std::string const& type) const;
-    std::vector<Symbol> get_child_symbols(ASTNode const&) const;
-    std::vector<Symbol> get_child_symbols(ASTNode const&, std::vector<std::string_view> const& scope, Symbol::IsLocal) const;
+    std::vector<Symbol> const& properties_of_type(DocumentData const& document, std::string const& type) const;
+    Cpp::Declaration const* find_declaration_of_type(DocumentData const&, std::string const& type) const;
+    std::vector<Symbol> const& members_of(DocumentData const&, StructOrClassDeclaration const&) const;
+    Cpp::Declaration const* find_declaration_of_base_class(DocumentData const&, StructOrClassDeclaration const&, Name const& base_class) const;
+    Cpp::Declaration const* find_declaration_of_property(DocumentData const&, Identifier const&) const;
+    void drop_stale_caches(DocumentData const&) const;
+    std::vector<Symbol> get_child_symbols(ASTNode const&, std::pmr::memory_resource&) const;
+    void collect_child_symbols(ASTNode const&, std::vector<std::string_view>& scope, Symbol::IsLocal, std::pmr::memory_resource&, std::vector<Symbol>& symbols) const;
+    void collect_outline_nodes(DocumentData const&, ASTNode const&, std::string const& scope, std::vector<OutlineNode>& nodes) const;
 
     DocumentData const* get_document_data(std::string const& file) const;
+    DocumentData const* document_of_declaration(Cpp::Declaration const&) const;
+    // Returns nullptr if the file can't be read, or if it was evicted and is on an #include cycle that is being parsed.
     DocumentData const* get_or_create_document_data(std::string const& file);
+    DocumentData const* get_or_create_indexed_document_data(std::string const& file);
+    DocumentData& document_for_update(DocumentData const&);
+    void ensure_symbols_are_declared(DocumentData const&);
+    void publish_document(DocumentData const&);
+    void mark_as_used(DocumentData const&);
+    // Returns false if the document can't be parsed again right now, it is removed if its file is gone.
+    bool rehydrate_document(std::string const& absolute_path);
+    // Whether the document may declare a symbol called 'name', without parsing it again if it was evicted.
+    static bool may_declare(DocumentData const&, std::string_view name);
+    // The document with its symbol table, rehydrated if it was evicted. 'document' is gone then, use the result instead.
+    // Returns nullptr if the document can't be rehydrated.
+    DocumentData const* parsed_document(DocumentData const&) const;
+    void evict_document(std::string const& absolute_path);
+    void enforce_memory_budget(size_t in_use_since);
     void set_document_data(std::string const& file, std::unique_ptr<DocumentData>&& data);
+    IncludedHeader const* get_or_create_included_header(std::string_view include_path);
 
     std::unique_ptr<DocumentData> create_document_data_for(std::string const& file);
     std::string document_path_from_include_path(std::string_view include_path) const;
     void update_declared_symbols(DocumentData&);
     void update_todo_entries(DocumentData&);
-    CodeComprehension::DeclarationType type_of_declaration(Cpp::Declaration const&);
-    std::vector<std::string_view> scope_of_node(ASTNode const&) const;
-    std::vector<std::string_view> scope_of_reference_to_symbol(ASTNode const&) const;
+    void update_function_signatures(DocumentData&, std::vector<Symbol> const&);
+    static bool has_include_guard(DocumentData const&);
+    static CodeComprehension::DeclarationType type_of_declaration(Cpp::Declaration const&);
+
+    // Allocated from m_request_arena, so only valid until the request ends.
+    using ScopeParts = std::pmr::vector<std::string_view>;
+    ScopeParts scope_of_node(ASTNode const&) const;
+    ScopeParts scope_of_reference_to_symbol(ASTNode const&) const;
 
     std::optional<CodeComprehension::ProjectLocation> find_preprocessor_definition(DocumentData const&, const GUI::TextPosition&);
-    std::optional<Cpp::Preprocessor::Substitution> find_preprocessor_substitution(DocumentData const&, Cpp::Position const&);
+    Cpp::Preprocessor::Substitution const* find_preprocessor_substitution(DocumentData const&, Cpp::Position const&) const;
 
     std::unique_ptr<DocumentData> create_document_data(std::string text, std::string const& filename);
     std::optional<std::vector<CodeComprehension::AutocompleteResultEntry>> try_autocomplete_property(DocumentData const&, ASTNode const&, std::optional<Token> containing_token) const;
     std::optional<std::vector<CodeComprehension::AutocompleteResultEntry>> try_autocomplete_name(DocumentData const&, ASTNode const&, std::optional<Token> containing_token) const;
     std::optional<std::vector<CodeComprehension::AutocompleteResultEntry>> try_autocomplete_include(DocumentData const&, Token include_path_token, Cpp::Position const& cursor_position) const;
-    static bool is_symbol_available(Symbol const&, std::vector<std::string_view> const& current_scope, std::vector<std::string_view> const& reference_scope);
+    static bool is_symbol_available(Symbol const&, std::span<std::string_view const> current_scope, std::span<std::string_view const> reference_scope);
     std::optional<FunctionParamsHint> get_function_params_hint(DocumentData const&, FunctionCall const&, size_t argument_index);
 
     template<typename Func>
     void for_each_available_symbol(DocumentData const&, Func) const;
 
+    template<typename Func>
+    void for_each_available_symbol_of_kind(DocumentData const&, SymbolKind, std::string_view name, Func) const;
+
     template<typename Func>
     void for_each_included_document_recursive(DocumentData const&, Func) const;
 
     CodeComprehension::TokenInfo::SemanticType get_token_semantic_type(DocumentData const&, Token const&);
     CodeComprehension::TokenInfo::SemanticType get_semantic_type_for_identifier(DocumentData const&, Position);
 
-    std::unordered_map<std::string, std::unique_ptr<DocumentData>> m_documents;
+    FlatHashMap<std::string, std::unique_ptr<DocumentData>> m_documents;
+
+    // Incremented whenever an existing document is replaced.
+    // A query cache of a document is only valid if it was filled in the current generation.
+    size_t m_documents_generation { 0 };
+
+    // See set_memory_budget(), 0 means no budget.
+    size_t m_memory_budget { 0 };
+    // Incremented whenever a document is used, so that documents can be ordered by their last use.
+    size_t m_use_clock { 0 };
+    // Documents that were opened or edited and haven't been closed yet, these are never evicted.
+    std::unordered_set<std::string> m_open_documents;
+
+    // Memoized #include resolution, keyed by the include path as it is written (e.g "<stdio.h>").
+    std::unordered_map<std::string, IncludedHeader> m_included_headers;
+    // The keys of m_included_headers by the absolute path of the header, so that a new version of a header drops its entries.
+    std::unordered_map<std::string, std::vector<std::string>> m_include_paths_of_headers;
+    // The sum of IncludedHeader::memory_usage, which counts towards the memory budget.
+    size_t m_included_headers_memory_usage { 0 };
+    // Include paths whose header couldn't be read. Only remembered until the outermost document that is being parsed is done,
+    // the header may be created before the next parse.
+    std::unordered_set<std::string> m_unreadable_include_paths;
 
     // A document's path will be in this set if we're currently processing it.
     // A document is added to this set when we start processing it (e.g because it was #included) and removed when we're done.
     // We use this to prevent circular #includes from looping indefinitely.
     std::unordered_set<std::string> m_unfinished_documents;
+
+    // Backs the temporaries of queries, every query entry point opens a scope of it.
+    mutable RequestArena m_request_arena;
 };
 
 enum IterationDecision {
@@ -210,8 +313,11 @@ void CppComprehensionEngine::for_each_available_symbol(DocumentData const& docum
             return;
     }
 
-    for_each_included_document_recursive(document, [&](DocumentData const& document) {
-        for (auto& item : document.m_symbols) {
+    for_each_included_document_recursive(document, [&](DocumentData const& included_document) {
+        auto const* parsed = parsed_document(included_document);
+        if (!parsed)
+            return IterationDecision::Continue;
+        for (auto& item : parsed->m_symbols) {
             auto decision = func(item.second);
             if (decision == IterationDecision::Break)
                 return IterationDecision::Break;
@@ -220,6 +326,34 @@ void CppComprehensionEngine::for_each_available_symbol(DocumentData const& docum
     });
 }
 
+// Only visits symbols of documents that may declare a symbol with the given name, the callback still has to check the name.
+template<typename Func>
+void CppComprehensionEngine::for_each_available_symbol_of_kind(DocumentData const& document, SymbolKind kind, std::string_view name, Func func) const
+{
+    auto kind_index = static_cast<size_t>(kind);
+    if (document.m_symbol_names.may_contain(name)) {
+        for (auto const* symbol : document.m_symbols_by_kind[kind_index]) {
+            auto decision = func(*symbol);
+            if (decision == IterationDecision::Break)
+                return;
+        }
+    }
+
+    for_each_included_document_recursive(document, [&](DocumentData const& included_document) {
+        if (!may_declare(included_document, name))
+            return IterationDecision::Continue;
+        auto const* parsed = parsed_document(included_document);
+        if (!parsed || !parsed->m_symbol_names.may_contain(name))
+            return IterationDecision::Continue;
+        for (auto const* symbol : parsed->m_symbols_by_kind[kind_index]) {
+            auto decision = func(*symbol);
+            if (decision == IterationDecision::Break)
+                return IterationDecision::Break;
+        }
+        return IterationDecision::Continue;
+    });
+}
+
 template<typename Func>
 void CppComprehensionEngine::for_each_included_document_recursive(DocumentData const& document, Func func) const
 {
@@ -229,7 +363,7 @@ void CppComprehensionEngine::for_each_included_document_recursive(DocumentData c
             continue;
         auto decision = func(*included_document);
         if (decision == IterationDecision::Break)
-            continue;
+            return;
     }
 }
 }
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "documentindex.hh"
+#include <algorithm>
+
+namespace CodeComprehension::Cpp {
+
+void DocumentIndex::build(std::string_view text, std::vector<Token> const& tokens)
+{
+    m_line_starts.clear();
+    m_line_starts.push_back(0);
+    m_text_length = text.length();
+    for (size_t i = 0; i < text.length(); ++i) {
+        if (text[i] == '\n')
+            m_line_starts.push_back(i + 1);
+    }
+
+    m_token_count = tokens.size();
+    m_entries.clear();
+    m_entries.reserve(m_token_count);
+    for (size_t i = 0; i < m_token_count; ++i) {
+        auto start = offset_of(tokens[i].start());
+        auto end = offset_of(tokens[i].end());
+        m_entries.push_back({ start, end, end, i });
+    }
+
+    // Tokens that came out of a macro substitution can share the position of the macro, so this isn't always sorted.
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](Entry const& a, Entry const& b) { return a.start < b.start; });
+    for (size_t i = 1; i < m_entries.size(); ++i)
+        m_entries[i].max_end = std::max(m_entries[i].max_end, m_entries[i - 1].max_end);
+
+    // A slot for every token and for every gap before, between and after them.
+    m_nodes_by_slot.assign(2 * m_token_count + 1, std::nullopt);
+}
+
+size_t DocumentIndex::offset_of(Position const& position) const
+{
+    if (m_line_starts.empty())
+        return position.column;
+    if (position.line >= m_line_starts.size())
+        return m_text_length;
+    auto line_start = m_line_starts[position.line];
+    // The end of a line is its newline (or the end of the text for the last line).
+    auto line_end = position.line + 1 < m_line_starts.size() ? m_line_starts[position.line + 1] - 1 : m_text_length;
+    return line_start + std::min(position.column, line_end - line_start);
+}
+
+std::optional<size_t> DocumentIndex::index_of_token_at(size_t offset) const
+{
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), offset, [](size_t offset, Entry const& entry) { return offset < entry.start; });
+
+    // Like Parser::token_at(), prefer the token that comes first in the token list.
+    std::optional<size_t> match;
+    while (it != m_entries.begin()) {
+        --it;
+        if (it->max_end < offset)
+            break;
+        if (it->end >= offset && (!match.has_value() || it->token_index < match.value()))
+            match = it->token_index;
+    }
+    return match;
+}
+
+size_t DocumentIndex::slot_of(size_t offset) const
+{
+    if (auto token_index = index_of_token_at(offset); token_index.has_value())
+        return 2 * token_index.value() + 1;
+
+    // Not inside of any token: the slot of the gap that ends at the next token.
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), offset, [](size_t offset, Entry const& entry) { return offset < entry.start; });
+    if (it == m_entries.end())
+        return 2 * m_token_count;
+    return 2 * it->token_index;
+}
+
+std::optional<Token> DocumentIndex::token_at(Parser const& parser, Position const& position) const
+{
+    auto token_index = index_of_token_at(offset_of(position));
+    if (!token_index.has_value())
+        return {};
+    return parser.tokens()[token_index.value()];
+}
+
+DocumentIndex::NodePtr DocumentIndex::node_at(Parser const& parser, Position const& position) const
+{
+    auto slot = slot_of(offset_of(position));
+    if (slot >= m_nodes_by_slot.size())
+        return parser.node_at(position);
+
+    auto& node = m_nodes_by_slot[slot];
+    if (!node.has_value())
+        node = parser.node_at(position);
+    return node.value();
+}
+
+size_t DocumentIndex::memory_usage() const
+{
+    return m_line_starts.capacity() * sizeof(size_t)
+        + m_entries.capacity() * sizeof(Entry)
+        + m_nodes_by_slot.capacity() * sizeof(std::optional<NodePtr>);
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cpp_parser/lexer.hh"
+#include "cpp_parser/parser.hh"
+
+namespace CodeComprehension::Cpp {
+
+using namespace ::Cpp;
+
+// Maps positions in a parsed document to its tokens and AST nodes without walking the whole token list or tree.
+//
+// Every AST node starts and ends on a token boundary, so all positions inside of a token (or inside of the gap
+// between two tokens) resolve to the same node. We call these ranges "slots" and remember the node of each slot
+// the first time it is looked up.
+//
+// The index only keeps offsets and token indices, the tokens themselves are the ones of the parser.
+class DocumentIndex {
+public:
+    using NodePtr = decltype(std::declval<Parser const&>().node_at(std::declval<Position>()));
+
+    void build(std::string_view text, std::vector<Token> const& tokens);
+
+    // Columns past the end of a line are clamped to the end of the line, like Parser::token_at() they don't reach into the next one.
+    size_t offset_of(Position const&) const;
+
+    std::optional<Token> token_at(Parser const&, Position const&) const;
+    NodePtr node_at(Parser const&, Position const&) const;
+
+    size_t token_count() const { return m_token_count; }
+    size_t memory_usage() const;
+
+private:
+    struct Entry {
+        size_t start { 0 };
+        size_t end { 0 };
+        // The largest 'end' of this entry and all entries before it.
+        size_t max_end { 0 };
+        size_t token_index { 0 };
+    };
+
+    std::optional<size_t> index_of_token_at(size_t offset) const;
+    size_t slot_of(size_t offset) const;
+
+    std::vector<size_t> m_line_starts;
+    size_t m_text_length { 0 };
+    size_t m_token_count { 0 };
+    // Tokens sorted by their start offset.
+    std::vector<Entry> m_entries;
+    mutable std::vector<std::optional<NodePtr>> m_nodes_by_slot;
+};
+
+}
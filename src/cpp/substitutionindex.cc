@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "substitutionindex.hh"
+#include <algorithm>
+
+namespace CodeComprehension::Cpp {
+
+void SubstitutionIndex::build(Preprocessor const& preprocessor)
+{
+    m_entries.clear();
+    m_entries.reserve(preprocessor.substitutions().size());
+    for (auto const& substitution : preprocessor.substitutions()) {
+        if (substitution.original_tokens.empty())
+            continue;
+        auto const& macro_token = substitution.original_tokens.front();
+        m_entries.push_back({ macro_token.start(), macro_token.end(), macro_token.end(), &substitution });
+    }
+
+    // Substitutions are recorded in order, so this is normally already sorted.
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](Entry const& a, Entry const& b) { return a.start < b.start; });
+
+    for (size_t i = 1; i < m_entries.size(); ++i) {
+        if (m_entries[i].max_end < m_entries[i - 1].max_end)
+            m_entries[i].max_end = m_entries[i - 1].max_end;
+    }
+}
+
+size_t SubstitutionIndex::upper_bound(Position const& position) const
+{
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), position, [](Position const& position, Entry const& entry) { return position < entry.start; });
+    return it - m_entries.begin();
+}
+
+Preprocessor::Substitution const* SubstitutionIndex::find(Position const& position) const
+{
+    // Return the earliest substitution that contains the position, like a linear search over the substitutions would.
+    Preprocessor::Substitution const* match = nullptr;
+    for (size_t i = upper_bound(position); i > 0; --i) {
+        auto const& entry = m_entries[i - 1];
+        if (entry.max_end < position)
+            break;
+        if (!(entry.end < position))
+            match = entry.substitution;
+    }
+    return match;
+}
+
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "cpp_parser/preprocessor.hh"
+
+namespace CodeComprehension::Cpp {
+
+using namespace ::Cpp;
+
+// Preprocessor substitutions sorted by the position of the macro token they replaced,
+// so that finding the substitution at a position is a binary search.
+class SubstitutionIndex {
+public:
+    void build(Preprocessor const&);
+
+    Preprocessor::Substitution const* find(Position const&) const;
+
+    size_t memory_usage() const { return m_entries.capacity() * sizeof(Entry); }
+
+private:
+    struct Entry {
+        Position start;
+        Position end;
+        // The largest 'end' of this entry and all entries before it.
+        // Lets lookups stop walking backwards as soon as no earlier entry can reach the position.
+        Position max_end;
+        Preprocessor::Substitution const* substitution { nullptr };
+    };
+
+    // Index of the first entry that starts after the given position.
+    size_t upper_bound(Position const&) const;
+
+    std::vector<Entry> m_entries;
+};
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "symbolname.hh"
+#include <fmt/format.h>
+#include <memory>
+
+namespace CodeComprehension::Cpp {
+
+// Calls 'callback' with every part of 'text' between the delimiters, like splitting it would.
+template<typename Callback>
+static void for_each_part(std::string_view text, std::string_view delimiter, Callback callback)
+{
+    size_t position = 0;
+    while (true) {
+        auto next_position = text.find(delimiter, position);
+        if (next_position == std::string_view::npos) {
+            callback(text.substr(position));
+            return;
+        }
+        callback(text.substr(position, next_position - position));
+        position = next_position + delimiter.size();
+    }
+}
+
+std::string SymbolName::scope_as_string() const
+{
+    if (scope.empty())
+        return "";
+
+    std::string builder;
+    for (size_t i = 0; i < scope.size() - 1; ++i) {
+        builder.append(fmt::format("{}::", scope[i]));
+    }
+    builder.append(scope.back());
+    return builder;
+}
+
+// The parts are split directly into the memory resource, so that names made in the request arena don't touch the heap.
+SymbolName SymbolName::create(std::string_view name, std::span<std::string_view const> scope, std::pmr::memory_resource& memory_resource)
+{
+    size_t part_count = 0;
+    for (auto scope_entry : scope)
+        for_each_part(scope_entry, "::", [&](std::string_view) { ++part_count; });
+    if (part_count == 0)
+        return SymbolName { name, {} };
+
+    auto* parts = std::pmr::polymorphic_allocator<std::string_view>(&memory_resource).allocate(part_count);
+    size_t index = 0;
+    for (auto scope_entry : scope)
+        for_each_part(scope_entry, "::", [&](std::string_view part) { std::construct_at(&parts[index++], part); });
+    return SymbolName { name, { parts, part_count } };
+}
+
+SymbolName SymbolName::create(std::string_view qualified_name, std::pmr::memory_resource& memory_resource)
+{
+    auto last_delimiter = qualified_name.rfind("::");
+    if (last_delimiter == std::string_view::npos)
+        return SymbolName { qualified_name, {} };
+    auto scope = qualified_name.substr(0, last_delimiter);
+    return SymbolName::create(qualified_name.substr(last_delimiter + 2), std::span { &scope, 1 }, memory_resource);
+}
+
+std::span<std::string_view const> SymbolName::copy_scope(std::span<std::string_view const> scope, std::pmr::memory_resource& memory_resource)
+{
+    if (scope.empty())
+        return {};
+    auto* parts = std::pmr::polymorphic_allocator<std::string_view>(&memory_resource).allocate(scope.size());
+    std::uninitialized_copy(scope.begin(), scope.end(), parts);
+    return { parts, scope.size() };
+}
+
+std::string SymbolName::to_byte_string() const
+{
+    if (scope.empty())
+        return std::string { name };
+    return fmt::format("{}::{}", scope_as_string(), name);
+}
+
+}
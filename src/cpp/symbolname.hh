@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace CodeComprehension::Cpp {
+
+// A name and the scope it is declared in, e.g "foo" in { "A", "B" } for A::B::foo.
+//
+// Doesn't own its scope, the parts are allocated from the memory resource given to create().
+// The symbols of a document use DocumentData::m_symbol_arena, temporary names use the request arena of the engine.
+// The hash is computed when the name is created, so that probing the symbol table of every document in an
+// include closure doesn't hash the same strings again.
+struct SymbolName {
+    std::string_view name;
+    std::span<std::string_view const> scope;
+    uint32_t hash { 0 };
+
+    SymbolName() = default;
+    // The parts of 'scope' must already be split.
+    SymbolName(std::string_view name, std::span<std::string_view const> scope)
+        : name(name)
+        , scope(scope)
+        , hash(compute_hash(name, scope))
+    {
+    }
+
+    // Scope entries that are qualified themselves (e.g "A::B") are split into their parts.
+    static SymbolName create(std::string_view, std::span<std::string_view const> scope, std::pmr::memory_resource&);
+    static SymbolName create(std::string_view qualified_name, std::pmr::memory_resource&);
+    static std::span<std::string_view const> copy_scope(std::span<std::string_view const>, std::pmr::memory_resource&);
+    std::string scope_as_string() const;
+    std::string to_byte_string() const;
+
+    bool operator==(SymbolName const& other) const
+    {
+        return hash == other.hash && name == other.name && std::equal(scope.begin(), scope.end(), other.scope.begin(), other.scope.end());
+    }
+
+    static constexpr uint32_t int_hash(uint32_t key)
+    {
+        key += ~(key << 15);
+        key ^= (key >> 10);
+        key += (key << 3);
+        key ^= (key >> 6);
+        key += ~(key << 11);
+        key ^= (key >> 16);
+        return key;
+    }
+
+    static constexpr uint32_t pair_int_hash(uint32_t key1, uint32_t key2)
+    {
+        return int_hash((int_hash(key1) * 209) ^ (int_hash(key2 * 413)));
+    }
+
+    static constexpr uint32_t string_hash(std::string_view string)
+    {
+        uint32_t hash = 0;
+        for (auto character : string) {
+            hash += static_cast<uint32_t>(character);
+            hash += (hash << 10);
+            hash ^= (hash >> 6);
+        }
+        hash += hash << 3;
+        hash ^= hash >> 11;
+        hash += hash << 15;
+        return hash;
+    }
+
+    static constexpr uint32_t compute_hash(std::string_view name, std::span<std::string_view const> scope)
+    {
+        uint32_t hash = pair_int_hash(0, string_hash(name));
+        for (auto scope_part : scope)
+            hash = pair_int_hash(hash, string_hash(scope_part));
+        return hash;
+    }
+};
+
+struct KeySymbolHash {
+    size_t operator()(SymbolName const& key) const { return key.hash; }
+};
+
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace CodeComprehension {
+
+// A hash map that keeps its entries densely packed in insertion order and finds them through an
+// open-addressing (linear probing) index. Iterating it is a walk over a contiguous array.
+//
+// The hash of every entry is computed once, when it is inserted. Lookups that probe many maps for
+// the same key can compute the key's hash once and pass it to find().
+//
+// Inserting may move all entries, erasing moves the last entry into the erased one's place.
+template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class FlatHashMap {
+public:
+    using value_type = std::pair<K, V>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    iterator begin() { return m_entries.begin(); }
+    iterator end() { return m_entries.end(); }
+    const_iterator begin() const { return m_entries.begin(); }
+    const_iterator end() const { return m_entries.end(); }
+
+    size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_hashes.clear();
+        m_slots.clear();
+    }
+
+    void reserve(size_t capacity)
+    {
+        m_entries.reserve(capacity);
+        m_hashes.reserve(capacity);
+        if (slot_count_for(capacity) > m_slots.size())
+            rehash(slot_count_for(capacity));
+    }
+
+    static size_t hash_of(K const& key) { return Hash {}(key); }
+
+    iterator find(K const& key) { return find(key, hash_of(key)); }
+    const_iterator find(K const& key) const { return find(key, hash_of(key)); }
+
+    iterator find(K const& key, size_t hash)
+    {
+        auto slot = find_slot(key, hash);
+        return slot.has_value() ? m_entries.begin() + m_slots[slot.value()].entry_index : m_entries.end();
+    }
+
+    const_iterator find(K const& key, size_t hash) const
+    {
+        auto slot = find_slot(key, hash);
+        return slot.has_value() ? m_entries.begin() + m_slots[slot.value()].entry_index : m_entries.end();
+    }
+
+    bool contains(K const& key) const { return find_slot(key, hash_of(key)).has_value(); }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(K key, Args&&... args)
+    {
+        auto hash = hash_of(key);
+        if (auto slot = find_slot(key, hash); slot.has_value())
+            return { m_entries.begin() + m_slots[slot.value()].entry_index, false };
+
+        insert_new(std::move(key), V(std::forward<Args>(args)...), hash);
+        return { m_entries.end() - 1, true };
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(K key, M&& value)
+    {
+        auto hash = hash_of(key);
+        if (auto slot = find_slot(key, hash); slot.has_value()) {
+            auto it = m_entries.begin() + m_slots[slot.value()].entry_index;
+            it->second = std::forward<M>(value);
+            return { it, false };
+        }
+
+        insert_new(std::move(key), V(std::forward<M>(value)), hash);
+        return { m_entries.end() - 1, true };
+    }
+
+    V& operator[](K const& key)
+    {
+        auto hash = hash_of(key);
+        if (auto slot = find_slot(key, hash); slot.has_value())
+            return m_entries[m_slots[slot.value()].entry_index].second;
+        insert_new(K(key), V(), hash);
+        return m_entries.back().second;
+    }
+
+    size_t erase(K const& key)
+    {
+        auto slot = find_slot(key, hash_of(key));
+        if (!slot.has_value())
+            return 0;
+        erase_slot(slot.value());
+        return 1;
+    }
+
+private:
+    static constexpr uint32_t empty_slot = std::numeric_limits<uint32_t>::max();
+
+    struct Slot {
+        uint32_t entry_index { empty_slot };
+        // The low bits of the entry's hash, lets probes skip most key comparisons.
+        uint32_t hash_bits { 0 };
+    };
+
+    // Keep the load factor of the index at or below 3/4.
+    static size_t slot_count_for(size_t entry_count)
+    {
+        size_t slot_count = 16;
+        while (slot_count * 3 < entry_count * 4)
+            slot_count *= 2;
+        return slot_count;
+    }
+
+    std::optional<size_t> find_slot(K const& key, size_t hash) const
+    {
+        if (m_slots.empty())
+            return {};
+        size_t mask = m_slots.size() - 1;
+        for (size_t index = hash & mask;; index = (index + 1) & mask) {
+            auto const& slot = m_slots[index];
+            if (slot.entry_index == empty_slot)
+                return {};
+            if (slot.hash_bits == static_cast<uint32_t>(hash) && KeyEqual {}(m_entries[slot.entry_index].first, key))
+                return index;
+        }
+    }
+
+    void place_in_index(uint32_t entry_index, size_t hash)
+    {
+        size_t mask = m_slots.size() - 1;
+        size_t index = hash & mask;
+        while (m_slots[index].entry_index != empty_slot)
+            index = (index + 1) & mask;
+        m_slots[index] = { entry_index, static_cast<uint32_t>(hash) };
+    }
+
+    void rehash(size_t slot_count)
+    {
+        m_slots.assign(slot_count, {});
+        for (size_t i = 0; i < m_entries.size(); ++i)
+            place_in_index(static_cast<uint32_t>(i), m_hashes[i]);
+    }
+
+    void insert_new(K&& key, V&& value, size_t hash)
+    {
+        assert(m_entries.size() < empty_slot);
+        if (slot_count_for(m_entries.size() + 1) > m_slots.size())
+            rehash(slot_count_for(m_entries.size() + 1));
+
+        m_entries.emplace_back(std::move(key), std::move(value));
+        m_hashes.push_back(hash);
+        place_in_index(static_cast<uint32_t>(m_entries.size() - 1), hash);
+    }
+
+    void erase_slot(size_t slot_index)
+    {
+        size_t mask = m_slots.size() - 1;
+        auto entry_index = m_slots[slot_index].entry_index;
+
+        // Backward-shift deletion: pull later entries of the probe sequence into the hole, so that no tombstones are needed.
+        m_slots[slot_index] = {};
+        size_t hole = slot_index;
+        for (size_t index = (hole + 1) & mask; m_slots[index].entry_index != empty_slot; index = (index + 1) & mask) {
+            size_t ideal_index = m_hashes[m_slots[index].entry_index] & mask;
+            if (((index - ideal_index) & mask) >= ((index - hole) & mask)) {
+                m_slots[hole] = m_slots[index];
+                m_slots[index] = {};
+                hole = index;
+            }
+        }
+
+        // Keep the entries dense by moving the last one into the erased one's place.
+        auto last_index = static_cast<uint32_t>(m_entries.size() - 1);
+        if (entry_index != last_index) {
+            size_t index = m_hashes[last_index] & mask;
+            while (m_slots[index].entry_index != last_index)
+                index = (index + 1) & mask;
+            m_slots[index].entry_index = entry_index;
+
+            m_entries[entry_index] = std::move(m_entries[last_index]);
+            m_hashes[entry_index] = m_hashes[last_index];
+        }
+        m_entries.pop_back();
+        m_hashes.pop_back();
+    }
+
+    std::vector<value_type> m_entries;
+    std::vector<size_t> m_hashes;
+    std::vector<Slot> m_slots;
+};
+
+}
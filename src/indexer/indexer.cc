@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+// Indexes every source and header of a project from the disk, writes the declarations that were found, and reports
+// how fast that went.
+//
+// Usage: indexer [--threads N] [--memory-budget BYTES] [--output FILE] [--slowest N] PROJECT_ROOT [FILE]...
+//
+// Files are distributed over the threads, see projectindexer.hh.
+// Given FILEs (relative to the project root), only those are indexed, e.g to reproduce a slow file from the field.
+// --output writes the declarations of every parsed document as JSON, sorted by file.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+
+#include "bench/harness.hh"
+#include "indexer/projectindexer.hh"
+
+using namespace CodeComprehension;
+
+namespace {
+
+char const* to_string(DeclarationType type)
+{
+    switch (type) {
+    case DeclarationType::Function:
+        return "Function";
+    case DeclarationType::Struct:
+        return "Struct";
+    case DeclarationType::Class:
+        return "Class";
+    case DeclarationType::Variable:
+        return "Variable";
+    case DeclarationType::PreprocessorDefinition:
+        return "PreprocessorDefinition";
+    case DeclarationType::Namespace:
+        return "Namespace";
+    case DeclarationType::Member:
+        return "Member";
+    }
+    return "";
+}
+
+bool write_index(std::string const& path, std::filesystem::path const& project_root, std::map<std::string, std::vector<Declaration>> const& declarations)
+{
+    FILE* stream = fopen(path.c_str(), "w");
+    if (!stream)
+        return false;
+    fprintf(stream, "{\n  \"project_root\": \"%s\",\n  \"documents\": [", Bench::escape_json(project_root.string()).c_str());
+    bool is_first_document = true;
+    for (auto const& [file, document_declarations] : declarations) {
+        fprintf(stream, "%s\n    { \"file\": \"%s\", \"declarations\": [", is_first_document ? "" : ",", Bench::escape_json(display_path(project_root, file)).c_str());
+        is_first_document = false;
+        for (size_t i = 0; i < document_declarations.size(); ++i) {
+            auto const& declaration = document_declarations[i];
+            fprintf(stream, "%s\n      { \"name\": \"%s\", \"type\": \"%s\", \"scope\": \"%s\", \"line\": %zu, \"column\": %zu }",
+                i == 0 ? "" : ",", Bench::escape_json(declaration.name).c_str(), to_string(declaration.type),
+                Bench::escape_json(declaration.scope).c_str(), declaration.position.line, declaration.position.column);
+        }
+        fprintf(stream, document_declarations.empty() ? "] }" : "\n    ] }");
+    }
+    fprintf(stream, "\n  ]\n}\n");
+    return fclose(stream) == 0;
+}
+
+size_t peak_resident_set_size()
+{
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+int usage(char const* program)
+{
+    fprintf(stderr, "Usage: %s [--threads N] [--memory-budget BYTES] [--output FILE] [--slowest N] PROJECT_ROOT [FILE]...\n", program);
+    return 1;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+    size_t slowest_count = 10;
+    std::optional<size_t> memory_budget;
+    std::optional<std::string> output_path;
+    std::optional<std::string> project_root_argument;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view argument = argv[i];
+        if (argument == "--threads" || argument == "--memory-budget" || argument == "--output" || argument == "--slowest") {
+            if (i + 1 >= argc)
+                return usage(argv[0]);
+            char const* value = argv[++i];
+            if (argument == "--threads")
+                thread_count = std::max<size_t>(1, std::stoul(value));
+            else if (argument == "--memory-budget")
+                memory_budget = std::stoul(value);
+            else if (argument == "--output")
+                output_path = value;
+            else
+                slowest_count = std::stoul(value);
+        } else if (argument.starts_with("--")) {
+            return usage(argv[0]);
+        } else if (!project_root_argument.has_value()) {
+            project_root_argument = argv[i];
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (!project_root_argument.has_value())
+        return usage(argv[0]);
+
+    std::error_code error;
+    auto project_root = std::filesystem::canonical(*project_root_argument, error);
+    if (error || !std::filesystem::is_directory(project_root)) {
+        fprintf(stderr, "%s is not a directory\n", project_root_argument->c_str());
+        return 1;
+    }
+    if (files.empty())
+        files = list_project_files(project_root);
+    if (files.empty()) {
+        fprintf(stderr, "No sources or headers in %s\n", project_root.c_str());
+        return 1;
+    }
+    thread_count = std::min(thread_count, files.size());
+
+    auto start = std::chrono::steady_clock::now();
+    auto index = index_project(project_root, files, thread_count, memory_budget);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    auto line_count = index.line_count();
+    printf("Indexed %zu files (%zu documents, %zu lines, %zu declarations) with %zu threads in %.3f s\n",
+        files.size(), index.line_counts.size(), line_count, index.declaration_count(), thread_count, seconds);
+    printf("%.1f files/s, %.1f lines/s, peak RSS %.1f MiB\n",
+        static_cast<double>(files.size()) / seconds, static_cast<double>(line_count) / seconds,
+        static_cast<double>(peak_resident_set_size()) / (1024 * 1024));
+
+    auto& file_times = index.file_times;
+    slowest_count = std::min(slowest_count, file_times.size());
+    if (slowest_count > 0) {
+        std::partial_sort(file_times.begin(), file_times.begin() + static_cast<std::ptrdiff_t>(slowest_count), file_times.end(),
+            [](auto const& a, auto const& b) { return a.milliseconds > b.milliseconds; });
+        printf("\n%-12s %s\n", "ms", "slowest files");
+        for (size_t i = 0; i < slowest_count; ++i)
+            printf("%-12.3f %s\n", file_times[i].milliseconds, file_times[i].file.c_str());
+    }
+
+    if (output_path.has_value() && !write_index(*output_path, project_root, index.declarations)) {
+        fprintf(stderr, "Unable to write %s\n", output_path->c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "projectindexer.hh"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#include "cpp/cppcomprehensionengine.hh"
+#include "filedb.hh"
+
+namespace CodeComprehension {
+
+namespace {
+
+// Reads files from the disk, and remembers the number of lines of every file it read.
+// Not thread-safe, every thread has its own.
+class DiskFileDB final : public FileDB {
+public:
+    explicit DiskFileDB(std::string const& project_root) { set_project_root(project_root); }
+
+    virtual std::optional<std::string> get_or_read_from_filesystem(std::string_view filename) const override
+    {
+        auto path = to_absolute_path(filename);
+        std::ifstream file(path);
+        if (!file)
+            return {};
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        auto content = buffer.str();
+        m_line_counts.insert_or_assign(std::move(path), static_cast<size_t>(std::count(content.begin(), content.end(), '\n')));
+        return content;
+    }
+
+    std::unordered_map<std::string, size_t> const& line_counts() const { return m_line_counts; }
+
+private:
+    mutable std::unordered_map<std::string, size_t> m_line_counts;
+};
+
+bool is_source_or_header(std::filesystem::path const& path)
+{
+    auto extension = path.extension();
+    return extension == ".c" || extension == ".cc" || extension == ".cpp" || extension == ".cxx"
+        || extension == ".h" || extension == ".hh" || extension == ".hpp" || extension == ".hxx";
+}
+
+ProjectIndex index_files(std::string const& project_root, std::vector<std::string> const& files, std::atomic<size_t>& next_file, std::optional<size_t> memory_budget)
+{
+    ProjectIndex result;
+    DiskFileDB filedb(project_root);
+    Cpp::CppComprehensionEngine engine(filedb);
+    engine.set_declarations_of_document_callback = [&](std::string const& filename, std::vector<Declaration>&& declarations) {
+        result.declarations.insert_or_assign(filename, std::move(declarations));
+    };
+    if (memory_budget.has_value())
+        engine.set_memory_budget(*memory_budget);
+
+    for (auto index = next_file++; index < files.size(); index = next_file++) {
+        auto start = std::chrono::steady_clock::now();
+        engine.index_document(files[index]);
+        auto end = std::chrono::steady_clock::now();
+        result.file_times.push_back({ files[index], std::chrono::duration<double, std::milli>(end - start).count() });
+    }
+    result.line_counts = filedb.line_counts();
+    return result;
+}
+
+}
+
+size_t ProjectIndex::line_count() const
+{
+    size_t count = 0;
+    for (auto const& [file, lines] : line_counts)
+        count += lines;
+    return count;
+}
+
+size_t ProjectIndex::declaration_count() const
+{
+    size_t count = 0;
+    for (auto const& [file, document_declarations] : declarations)
+        count += document_declarations.size();
+    return count;
+}
+
+std::vector<std::string> list_project_files(std::filesystem::path const& project_root)
+{
+    std::vector<std::string> files;
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(project_root, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        // Skip .git, .cache and the like.
+        if (it->path().filename().string().starts_with(".")) {
+            if (it->is_directory())
+                it.disable_recursion_pending();
+            continue;
+        }
+        if (it->is_regular_file() && is_source_or_header(it->path()))
+            files.push_back(std::filesystem::relative(it->path(), project_root).generic_string());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+ProjectIndex index_project(std::filesystem::path const& project_root, std::vector<std::string> const& files, size_t thread_count, std::optional<size_t> memory_budget)
+{
+    thread_count = std::clamp<size_t>(thread_count, 1, std::max<size_t>(1, files.size()));
+
+    std::atomic<size_t> next_file { 0 };
+    std::vector<ProjectIndex> thread_results(thread_count);
+    {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < thread_count; ++i) {
+            threads.emplace_back([&, i] {
+                thread_results[i] = index_files(project_root.string(), files, next_file, memory_budget);
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    // A header that is included by the files of several threads is published by each of them, with the same declarations.
+    ProjectIndex index;
+    for (auto& result : thread_results) {
+        index.declarations.merge(result.declarations);
+        index.line_counts.merge(result.line_counts);
+        std::move(result.file_times.begin(), result.file_times.end(), std::back_inserter(index.file_times));
+    }
+    return index;
+}
+
+std::string display_path(std::filesystem::path const& project_root, std::string const& file)
+{
+    auto relative = std::filesystem::path { file }.lexically_relative(project_root);
+    if (relative.empty() || *relative.begin() == "..")
+        return file;
+    return relative.generic_string();
+}
+
+}
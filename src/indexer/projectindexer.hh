@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "types.hh"
+
+namespace CodeComprehension {
+
+// Indexes the files of a project from the disk, see indexer.cc.
+//
+// Files are distributed over the threads, each of which has its own engine, so the headers that are included by
+// files of different threads are parsed once per thread. The time of a file includes parsing the headers it includes
+// that its thread didn't parse yet.
+struct ProjectIndex {
+    struct FileTime {
+        std::string file;
+        double milliseconds { 0 };
+    };
+
+    // The declarations of every parsed document (including the headers the files include), by absolute path.
+    std::map<std::string, std::vector<Declaration>> declarations;
+    // The number of lines of every file that was read, by absolute path.
+    std::unordered_map<std::string, size_t> line_counts;
+    // One per file that was given, grouped by thread.
+    std::vector<FileTime> file_times;
+
+    size_t line_count() const;
+    size_t declaration_count() const;
+};
+
+// The sources and headers below 'project_root', relative to it and sorted. Hidden files and directories are skipped.
+std::vector<std::string> list_project_files(std::filesystem::path const& project_root);
+
+// 'files' are relative to 'project_root'. 'thread_count' is capped at the number of files.
+ProjectIndex index_project(std::filesystem::path const& project_root, std::vector<std::string> const& files, size_t thread_count, std::optional<size_t> memory_budget = {});
+
+// Documents of the project are relative to its root, the others (e.g system headers) keep their absolute path.
+std::string display_path(std::filesystem::path const& project_root, std::string const& file);
+
+}
@@ -1,8 +1,17 @@
+#include <algorithm>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include "filedb.hh"
 #include "cpp/cppcomprehensionengine.hh"
+#include "corpus/corpusgenerator.hh"
+#include "flathashmap.hh"
+#include "indexer/projectindexer.hh"
+#include "session/recordingengine.hh"
+#include "symbolsearchindex.hh"
 
 using namespace CodeComprehension;
 
@@ -43,6 +52,11 @@ public:
         m_map.emplace(filename, content);
     }
 
+    void remove(std::string const& filename)
+    {
+        m_map.erase(filename);
+    }
+
     virtual std::optional<std::string> get_or_read_from_filesystem(std::string_view filename) const override
     {
         std::string target_filename = std::string{filename};
@@ -133,6 +147,29 @@ void test_complete_type()
     FAIL("wrong results");
 }
 
+void test_complete_inherited_members()
+{
+    I_TEST(Complete Inherited Members)
+    LocalFileDB filedb;
+    add_file(filedb, "complete_inherited_members.cc");
+    CodeComprehension::Cpp::CppComprehensionEngine autocomplete(filedb);
+    auto suggestions = autocomplete.get_suggestions("complete_inherited_members.cc", { 11, 7 });
+    if (suggestions.size() != 2)
+        FAIL(bad size);
+
+    if (suggestions[0].completion != "x_derived" || suggestions[1].completion != "x_base")
+        FAIL("wrong results");
+
+    // Top is a base of both Left and Right, its member is only listed once.
+    suggestions = autocomplete.get_suggestions("complete_inherited_members.cc", { 33, 7 });
+    if (suggestions.size() != 4)
+        FAIL("bad size with a diamond");
+    if (suggestions[0].completion != "x_bottom" || suggestions[1].completion != "x_left" || suggestions[2].completion != "x_top" || suggestions[3].completion != "x_right")
+        FAIL("wrong results with a diamond");
+
+    PASS;
+}
+
 void test_find_function_declaration()
 {
     I_TEST("Find Function Declaration");
@@ -172,6 +209,11 @@ void test_find_function_declaration()
 
     if (position.value().file != "find_function_declaration.cc" || position.value().line != 5)
         FAIL("wrong declaration location (4)");
+
+    // A column past the end of line 9 ("{") must not reach "foo" on the next line
+    position = engine.find_declaration_of("find_function_declaration.cc", { 9, 6 });
+    if (position.has_value())
+        FAIL("found a declaration past the end of a line");
     PASS;
 }
 
@@ -348,6 +390,490 @@ void test_parameters_hint()
     PASS;
 }
 
+void test_parameters_hint_overloads()
+{
+    I_TEST("Function Parameters hint with overloads")
+    LocalFileDB filedb;
+    filedb.set_project_root(TESTS_ROOT_DIR);
+    add_file(filedb, "parameters_hint_overloads.cc");
+    CodeComprehension::Cpp::CppComprehensionEngine engine(filedb);
+
+    auto result = engine.get_function_params_hint("parameters_hint_overloads.cc", { 5, 8 });
+    if (!result.has_value())
+        FAIL("failed to get parameters hint");
+    if (result->current_index != 0)
+        FAIL("bad argument index");
+
+    std::vector<std::string> two_params { "int x", "char y" };
+    std::vector<std::string> one_param { "int x" };
+    if (result->overloads.size() != 2)
+        FAIL("bad number of overloads");
+    if (std::find(result->overloads.begin(), result->overloads.end(), two_params) == result->overloads.end()
+        || std::find(result->overloads.begin(), result->overloads.end(), one_param) == result->overloads.end())
+        FAIL("wrong overloads");
+    if (std::find(result->overloads.begin(), result->overloads.end(), result->params) == result->overloads.end())
+        FAIL("params are not one of the overloads");
+
+    PASS;
+}
+
+void test_search_workspace_symbols()
+{
+    I_TEST("Search workspace symbols")
+    LocalFileDB filedb;
+    add_file(filedb, "find_function_declaration.cc");
+    add_file(filedb, "sample_header.hh");
+    CodeComprehension::Cpp::CppComprehensionEngine engine(filedb);
+    engine.index_document("find_function_declaration.cc");
+
+    auto results = engine.search_workspace_symbols("foo", 10);
+    if (results.size() < 3)
+        FAIL("bad size (1)");
+    if (results[0].name != "foo")
+        FAIL("wrong best match (1)");
+
+    results = engine.search_workspace_symbols("anfoo", 10);
+    if (results.empty() || results[0].name != "another_foo")
+        FAIL("wrong best match (2)");
+
+    results = engine.search_workspace_symbols("Foo", 1);
+    if (results.size() != 1 || results[0].name != "Foo" || results[0].position.file != "sample_header.hh")
+        FAIL("wrong best match (3)");
+
+    SymbolSearchIndex index;
+    index.set_declarations_of_document("a.cc", { { "get_suggestions", { "a.cc", 0, 0 }, DeclarationType::Function, "" }, { "gtsgts", { "a.cc", 1, 0 }, DeclarationType::Function, "" } });
+    index.set_declarations_of_document("b.cc", { { "get_value", { "b.cc", 0, 0 }, DeclarationType::Function, "" } });
+    // Queries shorter than a trigram look at every name, longer ones only at the names that share a trigram.
+    if (index.search("gt", 10).size() != 3)
+        FAIL("short query misses a name");
+    results = index.search("gtsg", 10);
+    if (results.size() != 1 || results[0].name != "gtsgts")
+        FAIL("match without a shared trigram");
+    if (index.search("get", 1).size() != 1 || index.search("get", 10).size() != 2)
+        FAIL("wrong results for a limit");
+
+    // Republishing and removing documents moves entries around in the posting lists.
+    index.set_declarations_of_document("a.cc", { { "set_suggestions", { "a.cc", 0, 0 }, DeclarationType::Function, "" } });
+    results = index.search("get", 10);
+    if (results.size() != 1 || results[0].name != "get_value")
+        FAIL("removed name still found");
+    index.remove_document("b.cc");
+    results = index.search("ugges", 10);
+    if (!index.search("get", 10).empty() || index.size() != 1 || results.size() != 1 || results[0].name != "set_suggestions")
+        FAIL("wrong names after removing a document");
+
+    PASS;
+}
+
+void test_document_outline()
+{
+    I_TEST("Document outline")
+    LocalFileDB filedb;
+    add_file(filedb, "find_symbol_in_namespace.cc");
+    add_file(filedb, "sample_header.hh");
+    CodeComprehension::Cpp::CppComprehensionEngine engine(filedb);
+
+    auto outline = engine.document_outline("find_symbol_in_namespace.cc");
+    if (!outline)
+        FAIL("no outline");
+    if (outline->size() != 3)
+        FAIL("bad number of top level declarations");
+
+    auto const& first_namespace = (*outline)[0];
+    if (first_namespace.declaration.name != "S" || first_namespace.declaration.type != DeclarationType::Namespace)
+        FAIL("wrong namespace");
+    if (first_namespace.children.size() != 1 || first_namespace.children[0].declaration.name != "f" || first_namespace.children[0].declaration.scope != "S")
+        FAIL("wrong namespace members");
+
+    if ((*outline)[1].declaration.name != "foo" || !(*outline)[1].children.empty())
+        FAIL("wrong function");
+
+    auto const& second_namespace = (*outline)[2];
+    if (second_namespace.children.size() != 2 || second_namespace.children[1].declaration.name != "R")
+        FAIL("wrong namespace members (2)");
+    auto const& class_node = second_namespace.children[1];
+    if (class_node.children.size() != 1 || class_node.children[0].declaration.name != "i" || class_node.children[0].declaration.scope != "S::R")
+        FAIL("wrong class members");
+
+    if (engine.document_outline("find_symbol_in_namespace.cc") != outline)
+        FAIL("outline was not cached");
+
+    PASS;
+}
+
+void test_memory_budget()
+{
+    I_TEST("Memory budget")
+    LocalFileDB filedb;
+    add_file(filedb, "find_function_declaration.cc");
+    add_file(filedb, "sample_header.hh");
+    add_file(filedb, "complete_local_vars.cc");
+    CodeComprehension::Cpp::CppComprehensionEngine engine(filedb);
+    engine.set_memory_budget(1);
+
+    auto is_evicted = [&](std::string const& file) {
+        auto usage = engine.memory_usage();
+        auto it = std::find_if(usage.begin(), usage.end(), [&](auto const& entry) { return entry.file == file; });
+        return it != usage.end() && it->is_evicted;
+    };
+
+    auto position = engine.find_declaration_of("find_function_declaration.cc", { 11, 6 });
+    if (!position.has_value() || position.value().file != "sample_header.hh")
+        FAIL("declaration not found (1)");
+    if (is_evicted("find_function_declaration.cc") || is_evicted("sample_header.hh"))
+        FAIL("documents of the current request were evicted");
+
+    // A request for an unrelated document pushes the least recently used ones out.
+    engine.get_suggestions("complete_local_vars.cc", { 3, 7 });
+    if (!is_evicted("find_function_declaration.cc") || !is_evicted("sample_header.hh"))
+        FAIL("documents were not evicted");
+
+    // The document declares the name itself, so the evicted header isn't parsed again.
+    position = engine.find_declaration_of("find_function_declaration.cc", { 10, 6 });
+    if (!position.has_value() || position.value().file != "find_function_declaration.cc")
+        FAIL("declaration in the document not found");
+    if (!is_evicted("sample_header.hh"))
+        FAIL("header was rehydrated without being needed");
+
+    position = engine.find_declaration_of("find_function_declaration.cc", { 11, 6 });
+    if (!position.has_value() || position.value().file != "sample_header.hh")
+        FAIL("declaration not found after rehydration");
+    if (is_evicted("find_function_declaration.cc") || is_evicted("sample_header.hh") || !is_evicted("complete_local_vars.cc"))
+        FAIL("wrong documents evicted");
+
+    // Open documents stay no matter what.
+    engine.file_opened("complete_local_vars.cc");
+    engine.find_declaration_of("find_function_declaration.cc", { 11, 6 });
+    if (is_evicted("complete_local_vars.cc"))
+        FAIL("open document was evicted");
+
+    PASS;
+}
+
+void test_deleted_document_declarations()
+{
+    I_TEST("Declarations of a deleted document")
+    LocalFileDB filedb;
+    add_file(filedb, "find_function_declaration.cc");
+    add_file(filedb, "sample_header.hh");
+    add_file(filedb, "complete_local_vars.cc");
+    CodeComprehension::Cpp::CppComprehensionEngine engine(filedb);
+    engine.set_memory_budget(1);
+
+    engine.index_document("find_function_declaration.cc");
+    if (engine.search_workspace_symbols("Foo", 1).size() != 1)
+        FAIL("declaration not found");
+
+    // The header is evicted, and its file is gone when a query wants it back.
+    engine.get_suggestions("complete_local_vars.cc", { 3, 7 });
+    filedb.remove("sample_header.hh");
+    engine.get_tokens_info("sample_header.hh");
+    if (!engine.search_workspace_symbols("Foo", 1).empty())
+        FAIL("declaration of a deleted document found");
+    if (engine.search_workspace_symbols("foobar", 1).size() != 1)
+        FAIL("declaration of another document not found");
+
+    PASS;
+}
+
+void test_unresolvable_and_cyclic_includes()
+{
+    I_TEST("Unresolvable and cyclic includes")
+    LocalFileDB filedb;
+    filedb.add("cycle_main.cc", "#include \"missing.hh\"\n#include \"cycle_a.hh\"\n#include \"missing.hh\"\nint main()\n{\n    a_function();\n    b_function();\n}\n");
+    filedb.add("cycle_a.hh", "#pragma once\n#include \"cycle_b.hh\"\nvoid a_function();\n");
+    filedb.add("cycle_b.hh", "#pragma once\n#include \"cycle_a.hh\"\nvoid b_function();\n");
+    CodeComprehension::Cpp::CppComprehensionEngine engine(filedb);
+
+    auto check_declarations = [&] {
+        auto position = engine.find_declaration_of("cycle_main.cc", { 5, 6 });
+        if (!position.has_value() || position->file != "cycle_a.hh" || position->line != 2)
+            return false;
+        position = engine.find_declaration_of("cycle_main.cc", { 6, 6 });
+        return position.has_value() && position->file == "cycle_b.hh" && position->line == 2;
+    };
+    if (!check_declarations())
+        FAIL("declaration not found");
+
+    // Evict everything and parse the cycle again.
+    engine.set_memory_budget(1);
+    engine.get_suggestions("cycle_b.hh", { 2, 5 });
+    if (!check_declarations())
+        FAIL("declaration not found after rehydration");
+
+    engine.index_document("cycle_main.cc");
+    auto usage = engine.memory_usage();
+    if (usage.size() != 3 || engine.statistics().documents.size() != 3)
+        FAIL("wrong documents");
+    if (std::any_of(usage.begin(), usage.end(), [](auto const& entry) { return entry.file == "missing.hh"; }))
+        FAIL("unresolvable include has a document");
+
+    PASS;
+}
+
+void test_header_created_later()
+{
+    I_TEST("Header created after its includer")
+    LocalFileDB filedb;
+    filedb.add("later_main.cc", "#include \"later.hh\"\nint main()\n{\n    later_function();\n}\n");
+    CodeComprehension::Cpp::CppComprehensionEngine engine(filedb);
+    if (engine.find_declaration_of("later_main.cc", { 3, 6 }).has_value())
+        FAIL("declaration found in a missing header");
+
+    filedb.add("later.hh", "#pragma once\nvoid later_function();\n");
+    engine.on_edit("later_main.cc");
+    auto position = engine.find_declaration_of("later_main.cc", { 3, 6 });
+    if (!position.has_value() || position->file != "later.hh" || position->line != 1)
+        FAIL("declaration not found after the header was created");
+
+    PASS;
+}
+
+void test_flat_hash_map()
+{
+    I_TEST("Flat hash map")
+    // Keys 100 * n + m want to go into slot n, so the tests decide which probe sequences are shared.
+    struct SlotHash {
+        size_t operator()(size_t key) const { return key / 100; }
+    };
+    FlatHashMap<size_t, size_t, SlotHash> map;
+    auto has_exactly = [&](std::vector<size_t> const& keys) {
+        if (map.size() != keys.size())
+            return false;
+        for (auto key : keys) {
+            auto it = map.find(key);
+            if (it == map.end() || it->second != key + 1)
+                return false;
+        }
+        size_t iterated = 0;
+        for (auto const& [key, value] : map)
+            iterated += std::find(keys.begin(), keys.end(), key) != keys.end() && value == key + 1;
+        return iterated == keys.size();
+    };
+
+    // Erasing from the middle of a probe chain pulls the rest of the chain, and the entries behind it, back.
+    for (size_t key : { 300, 301, 302, 400 })
+        map.emplace(key, key + 1);
+    if (map.erase(301) != 1 || map.erase(301) != 0 || map.contains(301))
+        FAIL("erased key still found");
+    if (!has_exactly({ 300, 302, 400 }))
+        FAIL("wrong entries after erasing inside a probe chain");
+
+    // The chain starting in the last slot wraps around to the start of the table.
+    map.clear();
+    for (size_t key : { 1400, 1401, 1500, 1501, 0 })
+        map.emplace(key, key + 1);
+    map.erase(1401);
+    if (!has_exactly({ 1400, 1500, 1501, 0 }))
+        FAIL("wrong entries after erasing across the end of the table");
+    map.erase(1400);
+    if (!has_exactly({ 1500, 1501, 0 }))
+        FAIL("wrong entries after erasing the start of a wrapped chain");
+
+    // Erased keys can be inserted again, and assigning to an existing key doesn't add an entry.
+    if (!map.emplace(1400, 1401).second || !map.insert_or_assign(1401, 1402).second)
+        FAIL("erased key not inserted again");
+    map.erase(0);
+    if (map.insert_or_assign(1500, 0).second || map.insert_or_assign(1500, 1501).second)
+        FAIL("existing key inserted again");
+    if (!has_exactly({ 1400, 1401, 1500, 1501 }))
+        FAIL("wrong entries after inserting again");
+
+    PASS;
+}
+
+void test_statistics()
+{
+    I_TEST("Statistics")
+    LocalFileDB filedb;
+    add_file(filedb, "find_function_declaration.cc");
+    add_file(filedb, "sample_header.hh");
+    CodeComprehension::Cpp::CppComprehensionEngine engine(filedb);
+    engine.find_declaration_of("find_function_declaration.cc", { 11, 6 });
+    engine.find_declaration_of("find_function_declaration.cc", { 10, 6 });
+    engine.on_edit("find_function_declaration.cc");
+
+    auto statistics = engine.statistics();
+    auto latency = std::find_if(statistics.latencies.begin(), statistics.latencies.end(), [](auto const& entry) { return entry.api == EngineApi::FindDeclarationOf; });
+    if (latency == statistics.latencies.end() || latency->latency.count != 2 || latency->latency.max < latency->latency.p50)
+        FAIL("wrong latency histogram");
+    if (Allocations::is_compiled_in && latency->allocations.count == 0)
+        FAIL("allocations not counted");
+
+    if (statistics.counter(EngineCounter::Parses) != 3 || statistics.counter(EngineCounter::Reparses) != 1)
+        FAIL("wrong parse counters");
+    if (statistics.counter(EngineCounter::IncludeResolutionHits) == 0 || statistics.include_resolution_hit_rate() <= 0)
+        FAIL("include resolution hits not counted");
+    if (statistics.documents.size() != 2 || statistics.total_bytes() == 0 || statistics.total_symbol_count() == 0)
+        FAIL("wrong document statistics");
+
+    auto json = statistics.to_json();
+    if (json.find("\"FindDeclarationOf\":{\"count\":2") == std::string::npos)
+        FAIL("latency missing from json");
+
+    PASS;
+}
+
+void test_session_record_replay()
+{
+    I_TEST("Session record and replay")
+    auto session_path = (std::filesystem::temp_directory_path() / "code-comprehension-test.session").string();
+    LocalFileDB filedb;
+    add_file(filedb, "find_function_declaration.cc");
+    add_file(filedb, "sample_header.hh");
+
+    std::optional<CodeComprehension::ProjectLocation> recorded_location;
+    {
+        auto writer = SessionWriter::create(session_path, filedb.project_root());
+        if (!writer)
+            FAIL("unable to create session");
+        RecordingEngine engine(filedb, std::move(writer), [](FileDB const& recording_filedb) {
+            return std::make_unique<CodeComprehension::Cpp::CppComprehensionEngine>(recording_filedb);
+        });
+        engine.file_opened("find_function_declaration.cc");
+        recorded_location = engine.find_declaration_of("find_function_declaration.cc", { 10, 6 });
+        engine.on_edit("find_function_declaration.cc");
+        engine.get_tokens_info("find_function_declaration.cc");
+        engine.search_workspace_symbols("foo", 3);
+    }
+
+    auto session = read_session(session_path);
+    std::filesystem::remove(session_path);
+    if (!session.has_value() || session->calls.size() != 5 || session->calls[1].type != SessionCallType::FindDeclarationOf)
+        FAIL("wrong calls in session");
+    auto const& search_call = session->calls[4];
+    if (search_call.type != SessionCallType::SearchWorkspaceSymbols || search_call.file != "foo" || search_call.number != 3)
+        FAIL("workspace symbol search not recorded");
+    // on_edit() reads the same content again, which is only stored once.
+    if (session->contents.empty() || session->contents.size() > 2)
+        FAIL("file contents not deduplicated");
+
+    SessionFileDB session_filedb(*session);
+    CodeComprehension::Cpp::CppComprehensionEngine engine(session_filedb);
+    session_filedb.apply(session->calls[0].file_reads);
+    replay_call(engine, session->calls[0]);
+    session_filedb.apply(session->calls[1].file_reads);
+    auto replayed_location = engine.find_declaration_of(session->calls[1].file, session->calls[1].position);
+    if (!recorded_location.has_value() || !replayed_location.has_value() || replayed_location->line != recorded_location->line || replayed_location->file != recorded_location->file)
+        FAIL("replay has a different result");
+
+    PASS;
+}
+
+// Whether a generated file includes itself, directly or through other files.
+static bool has_include_cycle(std::vector<GeneratedFile> const& files)
+{
+    std::unordered_map<std::string, std::vector<std::string>> includes;
+    for (auto const& file : files) {
+        std::istringstream lines(file.content);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (line.starts_with("#include \"") && line.ends_with("\""))
+                includes[file.path].push_back(line.substr(10, line.length() - 11));
+        }
+    }
+
+    for (auto const& file : files) {
+        std::vector<std::string> pending { file.path };
+        std::unordered_set<std::string> visited;
+        while (!pending.empty()) {
+            auto current = std::move(pending.back());
+            pending.pop_back();
+            for (auto const& included : includes[current]) {
+                if (included == file.path)
+                    return true;
+                if (visited.insert(included).second)
+                    pending.push_back(included);
+            }
+        }
+    }
+    return false;
+}
+
+void test_generated_corpus()
+{
+    I_TEST("Generated corpus")
+    CorpusOptions options;
+    options.source_count = 2;
+    options.macro_density = 0.5;
+    options.include_cycles = true;
+    auto files = generate_corpus(options);
+    if (files != generate_corpus(options))
+        FAIL("generator is not deterministic");
+    if (!has_include_cycle(files))
+        FAIL("include cycle not generated");
+
+    CorpusOptions single_level_options = options;
+    single_level_options.include_depth = 1;
+    if (!has_include_cycle(generate_corpus(single_level_options)))
+        FAIL("include cycle not generated with a single level");
+
+    LocalFileDB filedb;
+    std::string const* source = nullptr;
+    for (auto const& file : files) {
+        filedb.add(file.path, file.content);
+        if (file.path == "src/source_0.cc")
+            source = &file.content;
+    }
+    if (!source)
+        FAIL("source not generated");
+
+    auto position_of = [&](std::string_view text) -> std::optional<GUI::TextPosition> {
+        auto offset = source->find(text);
+        if (offset == std::string::npos)
+            return {};
+        auto line_start = source->rfind('\n', offset);
+        line_start = line_start == std::string::npos ? 0 : line_start + 1;
+        return GUI::TextPosition { static_cast<size_t>(std::count(source->begin(), source->begin() + offset, '\n')), offset - line_start };
+    };
+
+    CodeComprehension::Cpp::CppComprehensionEngine engine(filedb);
+    engine.file_opened("src/source_0.cc");
+
+    for (auto const* call : { "method_0(", "function_0_" }) {
+        auto position = position_of(call);
+        if (!position.has_value())
+            FAIL("call not generated");
+        auto declaration = engine.find_declaration_of("src/source_0.cc", position.value());
+        if (!declaration.has_value() || !declaration.value().file.starts_with("include/level0/"))
+            FAIL("declaration not found in header");
+    }
+
+    PASS;
+}
+
+void test_index_project()
+{
+    I_TEST("Index project")
+    std::filesystem::path project_root { TESTS_ROOT_DIR };
+    auto files = list_project_files(project_root);
+    if (std::find(files.begin(), files.end(), "sample_header.hh") == files.end())
+        FAIL("project files not listed");
+
+    auto index = index_project(project_root, files, 2);
+    if (index.file_times.size() != files.size())
+        FAIL("not every file indexed");
+
+    auto has_declaration = [&](std::string const& file, std::string const& name, DeclarationType type) {
+        for (auto const& [path, declarations] : index.declarations) {
+            if (display_path(project_root, path) != file)
+                continue;
+            return std::any_of(declarations.begin(), declarations.end(), [&](auto const& declaration) {
+                return declaration.name == name && declaration.type == type;
+            });
+        }
+        return false;
+    };
+    if (!has_declaration("sample_header.hh", "Foo", DeclarationType::Struct) || !has_declaration("find_function_declaration.cc", "baz", DeclarationType::Function))
+        FAIL("declaration missing");
+
+    // Every thread has its own engine, the declarations don't depend on which one parsed a document.
+    if (index_project(project_root, files, 1).declarations != index.declarations)
+        FAIL("declarations differ from a single thread");
+
+    PASS;
+}
+
 void test_ast_cpp() {
     I_TEST("Find Variable Declaration in AST.cpp")
     auto filename = "AST.cpp";
@@ -415,6 +941,7 @@ int main(int argc, char* argv[]) {
     test_complete_local_args();
     test_complete_local_vars();
     test_complete_type();
+    test_complete_inherited_members();
     test_find_function_declaration();
     test_find_variable_definition();
     test_namespace();
@@ -423,6 +950,18 @@ int main(int argc, char* argv[]) {
     test_find_array_variable_declaration_double();
     test_complete_includes();
     test_parameters_hint();
+    test_parameters_hint_overloads();
+    test_search_workspace_symbols();
+    test_document_outline();
+    test_memory_budget();
+    test_deleted_document_declarations();
+    test_unresolvable_and_cyclic_includes();
+    test_header_created_later();
+    test_flat_hash_map();
+    test_statistics();
+    test_session_record_replay();
+    test_generated_corpus();
+    test_index_project();
     test_ast_cpp();
     test_parser_cpp();
 
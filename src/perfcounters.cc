@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "perfcounters.hh"
+#include <algorithm>
+#include <cerrno>
+#include <tuple>
+#include <cstring>
+
+#ifdef __linux__
+#    include <linux/perf_event.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace CodeComprehension {
+
+namespace {
+
+constexpr char const* event_names[] = { "cycles", "instructions", "cache-misses", "branch-misses" };
+
+#ifdef __linux__
+constexpr uint64_t event_configs[] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+// The events are opened as one group, so that the kernel schedules them together and they are scaled by the same
+// factor if it has to multiplex them. 'group_fd' is -1 for the leader.
+int open_event(uint64_t config, int group_fd)
+{
+    perf_event_attr attributes {};
+    attributes.size = sizeof(attributes);
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.config = config;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid 0 and cpu -1: the calling thread, on any CPU.
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+uint64_t scale(uint64_t value, uint64_t time_enabled, uint64_t time_running)
+{
+    if (time_running == 0)
+        return 0;
+    if (time_running < time_enabled)
+        return static_cast<uint64_t>(static_cast<double>(value) * static_cast<double>(time_enabled) / static_cast<double>(time_running));
+    return value;
+}
+#endif
+
+}
+
+std::unique_ptr<PerfCounters> PerfCounters::create(std::string* error)
+{
+#ifdef __linux__
+    std::unique_ptr<PerfCounters> counters(new PerfCounters);
+    bool has_any_event = false;
+    int first_errno = 0;
+    int leader_fd = -1;
+    for (size_t i = 0; i < event_count; ++i) {
+        counters->m_fds[i] = open_event(event_configs[i], leader_fd);
+        if (counters->m_fds[i] >= 0) {
+            has_any_event = true;
+            if (leader_fd < 0)
+                leader_fd = counters->m_fds[i];
+        } else if (first_errno == 0) {
+            first_errno = errno;
+        }
+    }
+    if (has_any_event)
+        return counters;
+    if (error)
+        *error = std::string { "perf_event_open failed: " } + strerror(first_errno);
+    return nullptr;
+#else
+    if (error)
+        *error = "hardware counters are only supported on Linux";
+    return nullptr;
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    // The leader is the first open event, close it last.
+    for (auto it = m_fds.rbegin(); it != m_fds.rend(); ++it) {
+        if (*it >= 0)
+            close(*it);
+    }
+#endif
+}
+
+HardwareEventCounts PerfCounters::read() const
+{
+    HardwareEventCounts counts;
+#ifdef __linux__
+    auto leader = std::find_if(m_fds.begin(), m_fds.end(), [](int fd) { return fd >= 0; });
+    if (leader == m_fds.end())
+        return counts;
+
+    // Reading the leader returns the number of events, the times, and then the value of every event in the order
+    // they were added to the group, all in one syscall.
+    uint64_t values[3 + event_count] {};
+    auto bytes_read = ::read(*leader, values, sizeof(values));
+    if (bytes_read < static_cast<ssize_t>(3 * sizeof(uint64_t)))
+        return counts;
+    auto value_count = std::min<uint64_t>(values[0], static_cast<size_t>(bytes_read) / sizeof(uint64_t) - 3);
+    auto time_enabled = values[1];
+    auto time_running = values[2];
+
+    uint64_t* fields[] = { &counts.cycles, &counts.instructions, &counts.cache_misses, &counts.branch_misses };
+    size_t position = 0;
+    for (size_t i = 0; i < event_count && position < value_count; ++i) {
+        if (m_fds[i] >= 0)
+            *fields[i] = scale(values[3 + position++], time_enabled, time_running);
+    }
+#endif
+    return counts;
+}
+
+std::vector<std::string> PerfCounters::unavailable_events() const
+{
+    std::vector<std::string> events;
+    for (size_t i = 0; i < event_count; ++i) {
+        if (m_fds[i] < 0)
+            events.emplace_back(event_names[i]);
+    }
+    return events;
+}
+
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CodeComprehension {
+
+struct HardwareEventCounts {
+    uint64_t cycles { 0 };
+    uint64_t instructions { 0 };
+    // Last level cache misses.
+    uint64_t cache_misses { 0 };
+    uint64_t branch_misses { 0 };
+
+    // Scaled counts (see PerfCounters) are estimates that can go down between two reads, such differences are 0.
+    HardwareEventCounts operator-(HardwareEventCounts const& other) const
+    {
+        auto difference = [](uint64_t a, uint64_t b) { return a > b ? a - b : 0; };
+        return { difference(cycles, other.cycles), difference(instructions, other.instructions), difference(cache_misses, other.cache_misses), difference(branch_misses, other.branch_misses) };
+    }
+    HardwareEventCounts& operator+=(HardwareEventCounts const& other)
+    {
+        cycles += other.cycles;
+        instructions += other.instructions;
+        cache_misses += other.cache_misses;
+        branch_misses += other.branch_misses;
+        return *this;
+    }
+};
+
+// Hardware performance counters of the calling thread, read through perf_event_open(2).
+//
+// Only available on Linux, and only if the kernel lets us count (see /proc/sys/kernel/perf_event_paranoid);
+// inside of most containers it doesn't. Events that can't be counted read as 0, see unavailable_events().
+// The events are counted as one group, and are scaled up together if the kernel had to multiplex the counters.
+// An event that doesn't fit into the group with the others is unavailable as well.
+class PerfCounters {
+    PerfCounters(PerfCounters const&) = delete;
+    PerfCounters& operator=(PerfCounters const&) = delete;
+
+public:
+    // Returns nullptr if none of the events can be counted, 'error' (if given) is set to the reason.
+    static std::unique_ptr<PerfCounters> create(std::string* error = nullptr);
+    ~PerfCounters();
+
+    // The events counted on this thread since the counters were created.
+    HardwareEventCounts read() const;
+
+    std::vector<std::string> unavailable_events() const;
+
+private:
+    static constexpr size_t event_count = 4;
+
+    PerfCounters() = default;
+
+    // Indexed like the fields of HardwareEventCounts, -1 if the event isn't available.
+    std::array<int, event_count> m_fds { -1, -1, -1, -1 };
+};
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "requestarena.hh"
+#include <algorithm>
+#include <cstdint>
+
+namespace CodeComprehension {
+
+RequestArena::RequestArena(size_t initial_block_size, std::pmr::memory_resource* upstream)
+    : m_initial_block_size(initial_block_size)
+    , m_upstream(upstream)
+{
+}
+
+RequestArena::Scope::Scope(RequestArena& arena)
+    : m_arena(arena)
+    , m_block_index(arena.m_block_index)
+    , m_offset(arena.m_offset)
+{
+    ++m_arena.m_scope_depth;
+}
+
+RequestArena::Scope::~Scope()
+{
+    m_arena.m_block_index = m_block_index;
+    m_arena.m_offset = m_offset;
+    if (--m_arena.m_scope_depth != 0 || m_arena.m_blocks.size() <= 1)
+        return;
+
+    // The last request didn't fit into one block, make sure that the next one does.
+    auto capacity = m_arena.capacity();
+    m_arena.m_blocks.clear();
+    m_arena.add_block(capacity);
+    m_arena.m_block_index = 0;
+    m_arena.m_offset = 0;
+}
+
+size_t RequestArena::capacity() const
+{
+    size_t capacity = 0;
+    for (auto const& block : m_blocks)
+        capacity += block.size;
+    return capacity;
+}
+
+size_t RequestArena::bytes_in_use() const
+{
+    size_t bytes = m_offset;
+    for (size_t i = 0; i < m_block_index && i < m_blocks.size(); ++i)
+        bytes += m_blocks[i].size;
+    return bytes;
+}
+
+void RequestArena::add_block(size_t minimum_size)
+{
+    auto size = std::max(minimum_size, m_blocks.empty() ? m_initial_block_size : m_blocks.back().size * 2);
+    m_blocks.push_back({ std::make_unique<std::byte[]>(size), size });
+}
+
+void* RequestArena::do_allocate(size_t bytes, size_t alignment)
+{
+    if (m_scope_depth == 0) {
+        auto* pointer = m_upstream->allocate(bytes, alignment);
+        m_upstream_allocations.emplace(pointer);
+        return pointer;
+    }
+
+    for (;;) {
+        if (m_block_index < m_blocks.size()) {
+            auto& block = m_blocks[m_block_index];
+            auto address = reinterpret_cast<uintptr_t>(block.data.get());
+            auto offset = ((address + m_offset + alignment - 1) & ~(alignment - 1)) - address;
+            if (offset + bytes <= block.size) {
+                m_offset = offset + bytes;
+                return block.data.get() + offset;
+            }
+            // A block that is too small for this allocation stays unused until the scope that is using it ends.
+            if (m_block_index + 1 < m_blocks.size()) {
+                ++m_block_index;
+                m_offset = 0;
+                continue;
+            }
+        }
+        add_block(bytes + alignment);
+        m_block_index = m_blocks.size() - 1;
+        m_offset = 0;
+    }
+}
+
+void RequestArena::do_deallocate(void* pointer, size_t bytes, size_t alignment)
+{
+    // Memory of a scope is released when the scope ends.
+    if (m_upstream_allocations.empty() || m_upstream_allocations.erase(pointer) == 0)
+        return;
+    m_upstream->deallocate(pointer, bytes, alignment);
+}
+
+}
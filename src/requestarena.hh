@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <unordered_set>
+#include <vector>
+
+namespace CodeComprehension {
+
+// A bump allocator for the temporaries of a single request (e.g the scope vectors of a name lookup).
+//
+// Memory can only be allocated inside of a Scope, and everything allocated inside of it is released at once
+// when the scope ends; deallocating is a no-op. Scopes nest, so a loop can release the temporaries of every
+// iteration. The blocks are kept between requests, and merged into one once the outermost scope ends, so that
+// a steady stream of requests allocates nothing from the heap.
+//
+// Nothing allocated in a scope may outlive it, results that are returned to the caller have to be copied out.
+// Allocations outside of any scope have nothing to be released with, so they are forwarded to the upstream resource.
+class RequestArena final : public std::pmr::memory_resource {
+    RequestArena(RequestArena const&) = delete;
+    RequestArena& operator=(RequestArena const&) = delete;
+
+public:
+    class Scope {
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+    public:
+        explicit Scope(RequestArena&);
+        ~Scope();
+
+    private:
+        RequestArena& m_arena;
+        size_t m_block_index { 0 };
+        size_t m_offset { 0 };
+    };
+
+    explicit RequestArena(size_t initial_block_size = 64 * 1024, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    // e.g "auto arena_scope = m_request_arena.scope();"
+    [[nodiscard]] Scope scope() { return Scope(*this); }
+
+    size_t capacity() const;
+    size_t bytes_in_use() const;
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size { 0 };
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t bytes, size_t alignment) override;
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override { return this == &other; }
+
+    void add_block(size_t minimum_size);
+
+    size_t m_initial_block_size { 0 };
+    std::vector<Block> m_blocks;
+    size_t m_block_index { 0 };
+    size_t m_offset { 0 };
+    size_t m_scope_depth { 0 };
+    std::pmr::memory_resource* m_upstream { nullptr };
+    // What was allocated from m_upstream, and has to be deallocated there.
+    std::unordered_set<void*> m_upstream_allocations;
+};
+
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "recordingengine.hh"
+#include <cassert>
+
+namespace CodeComprehension {
+
+RecordingFileDB::RecordingFileDB(FileDB const& filedb, SessionWriter& writer)
+    : m_filedb(filedb)
+    , m_writer(writer)
+{
+    set_project_root(filedb.project_root());
+}
+
+std::optional<std::string> RecordingFileDB::get_or_read_from_filesystem(std::string_view filename) const
+{
+    auto content = m_filedb.get_or_read_from_filesystem(filename);
+    m_writer.write_file_read(filename, content);
+    return content;
+}
+
+RecordingEngine::RecordingEngine(FileDB const& filedb, std::unique_ptr<SessionWriter> writer, EngineFactory const& create_engine)
+    : CodeComprehensionEngine(filedb)
+    , m_writer(std::move(writer))
+    , m_recording_filedb(filedb, *m_writer)
+    , m_engine(create_engine(m_recording_filedb))
+{
+    assert(m_engine);
+    m_engine->set_declarations_of_document_callback = [this](std::string const& filename, std::vector<Declaration>&& declarations) {
+        set_declarations_of_document(filename, std::move(declarations));
+    };
+    m_engine->set_todo_entries_of_document_callback = [this](std::string const& filename, std::vector<TodoEntry>&& todo_entries) {
+        set_todo_entries_of_document(filename, std::move(todo_entries));
+    };
+}
+
+RecordingEngine::~RecordingEngine()
+{
+    // The engine may still read files while it's destroyed.
+    m_engine.reset();
+    m_writer->flush();
+}
+
+std::vector<AutocompleteResultEntry> RecordingEngine::get_suggestions(std::string const& file, GUI::TextPosition const& autocomplete_position)
+{
+    m_writer->write_call(SessionCallType::GetSuggestions, file, autocomplete_position);
+    return m_engine->get_suggestions(file, autocomplete_position);
+}
+
+void RecordingEngine::on_edit(std::string const& file)
+{
+    m_writer->write_call(SessionCallType::OnEdit, file);
+    m_engine->on_edit(file);
+}
+
+void RecordingEngine::file_opened(std::string const& file)
+{
+    m_writer->write_call(SessionCallType::FileOpened, file);
+    m_engine->file_opened(file);
+}
+
+void RecordingEngine::file_closed(std::string const& file)
+{
+    m_writer->write_call(SessionCallType::FileClosed, file);
+    m_engine->file_closed(file);
+}
+
+void RecordingEngine::index_document(std::string const& file)
+{
+    m_writer->write_call(SessionCallType::IndexDocument, file);
+    m_engine->index_document(file);
+}
+
+std::optional<ProjectLocation> RecordingEngine::find_declaration_of(std::string const& file, GUI::TextPosition const& identifier_position)
+{
+    m_writer->write_call(SessionCallType::FindDeclarationOf, file, identifier_position);
+    return m_engine->find_declaration_of(file, identifier_position);
+}
+
+std::optional<CodeComprehensionEngine::FunctionParamsHint> RecordingEngine::get_function_params_hint(std::string const& file, GUI::TextPosition const& identifier_position)
+{
+    m_writer->write_call(SessionCallType::GetFunctionParamsHint, file, identifier_position);
+    return m_engine->get_function_params_hint(file, identifier_position);
+}
+
+std::vector<TokenInfo> RecordingEngine::get_tokens_info(std::string const& file)
+{
+    m_writer->write_call(SessionCallType::GetTokensInfo, file);
+    return m_engine->get_tokens_info(file);
+}
+
+std::shared_ptr<DocumentOutline const> RecordingEngine::document_outline(std::string const& file)
+{
+    m_writer->write_call(SessionCallType::DocumentOutline, file);
+    return m_engine->document_outline(file);
+}
+
+std::vector<CodeComprehensionEngine::DocumentMemoryUsage> RecordingEngine::memory_usage() const
+{
+    return m_engine->memory_usage();
+}
+
+void RecordingEngine::set_memory_budget(size_t bytes)
+{
+    m_writer->write_call(SessionCallType::SetMemoryBudget, {}, { 0, 0 }, bytes);
+    m_engine->set_memory_budget(bytes);
+}
+
+std::vector<Declaration> RecordingEngine::search_workspace_symbols(std::string const& query, size_t limit) const
+{
+    m_writer->write_call(SessionCallType::SearchWorkspaceSymbols, query, { 0, 0 }, limit);
+    return m_engine->search_workspace_symbols(query, limit);
+}
+
+Statistics RecordingEngine::statistics() const
+{
+    return m_engine->statistics();
+}
+
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "codecomprehensionengine.hh"
+#include "filedb.hh"
+#include "session.hh"
+
+namespace CodeComprehension {
+
+// Forwards to the FileDB of the editor, and records every file that is read through it.
+class RecordingFileDB final : public FileDB {
+public:
+    RecordingFileDB(FileDB const& filedb, SessionWriter& writer);
+
+    virtual std::optional<std::string> get_or_read_from_filesystem(std::string_view filename) const override;
+
+private:
+    FileDB const& m_filedb;
+    SessionWriter& m_writer;
+};
+
+// Wraps an engine and records every call made to it into a session, see session.hh.
+//
+// The wrapped engine is created by 'create_engine' on top of a RecordingFileDB, so that the session contains the
+// files it reads. Declarations and TODO entries it publishes are passed on to the callbacks of the recording engine.
+class RecordingEngine final : public CodeComprehensionEngine {
+public:
+    using EngineFactory = std::function<std::unique_ptr<CodeComprehensionEngine>(FileDB const&)>;
+
+    RecordingEngine(FileDB const& filedb, std::unique_ptr<SessionWriter>, EngineFactory const& create_engine);
+    virtual ~RecordingEngine() override;
+
+    virtual std::vector<AutocompleteResultEntry> get_suggestions(std::string const& file, GUI::TextPosition const& autocomplete_position) override;
+    virtual void on_edit(std::string const& file) override;
+    virtual void file_opened(std::string const& file) override;
+    virtual void file_closed(std::string const& file) override;
+    virtual void index_document(std::string const& file) override;
+    virtual std::optional<ProjectLocation> find_declaration_of(std::string const& file, GUI::TextPosition const& identifier_position) override;
+    virtual std::optional<FunctionParamsHint> get_function_params_hint(std::string const& file, GUI::TextPosition const& identifier_position) override;
+    virtual std::vector<TokenInfo> get_tokens_info(std::string const& file) override;
+    virtual std::shared_ptr<DocumentOutline const> document_outline(std::string const& file) override;
+    virtual std::vector<DocumentMemoryUsage> memory_usage() const override;
+    virtual void set_memory_budget(size_t bytes) override;
+    virtual std::vector<Declaration> search_workspace_symbols(std::string const& query, size_t limit) const override;
+    virtual Statistics statistics() const override;
+
+    // Writes out everything recorded so far, e.g before the session file is copied elsewhere.
+    void flush() { m_writer->flush(); }
+
+private:
+    std::unique_ptr<SessionWriter> m_writer;
+    RecordingFileDB m_recording_filedb;
+    std::unique_ptr<CodeComprehensionEngine> m_engine;
+};
+
+}
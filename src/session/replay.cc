@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+// Replays a recorded session (see RecordingEngine) against the C++ engine of this build, and reports the latency
+// distribution of every type of call.
+//
+// Usage: replay [--repetitions N] [--json FILE] SESSION
+//
+// Every repetition replays the whole session on a new engine, so the first calls include parsing just like
+// they did when the session was recorded.
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "bench/harness.hh"
+#include "cpp/cppcomprehensionengine.hh"
+#include "session/session.hh"
+
+using namespace CodeComprehension;
+
+namespace {
+
+int usage(char const* program)
+{
+    fprintf(stderr, "Usage: %s [--repetitions N] [--json FILE] SESSION\n", program);
+    return 1;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t repetitions = 1;
+    std::optional<std::string> json_path;
+    std::optional<std::string> session_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view argument = argv[i];
+        if (argument == "--repetitions" || argument == "--json") {
+            if (i + 1 >= argc)
+                return usage(argv[0]);
+            char const* value = argv[++i];
+            if (argument == "--repetitions")
+                repetitions = std::stoul(value);
+            else
+                json_path = value;
+        } else if (!session_path.has_value() && !argument.starts_with("--")) {
+            session_path = argv[i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (!session_path.has_value())
+        return usage(argv[0]);
+
+    std::string error;
+    auto session = read_session(*session_path, &error);
+    if (!session.has_value()) {
+        fprintf(stderr, "Unable to read session: %s\n", error.c_str());
+        return 1;
+    }
+
+    std::map<SessionCallType, std::vector<double>> samples;
+    std::vector<double> session_samples;
+    for (size_t repetition = 0; repetition < repetitions; ++repetition) {
+        SessionFileDB filedb(*session);
+        Cpp::CppComprehensionEngine engine(filedb);
+
+        auto session_start = std::chrono::steady_clock::now();
+        for (auto const& call : session->calls) {
+            filedb.apply(call.file_reads);
+            auto start = std::chrono::steady_clock::now();
+            replay_call(engine, call);
+            auto end = std::chrono::steady_clock::now();
+            samples[call.type].push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+        session_samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - session_start).count());
+    }
+
+    auto session_name = std::filesystem::path(*session_path).filename().string();
+    std::vector<Bench::Result> results;
+    for (auto& [type, type_samples] : samples)
+        results.push_back(Bench::summarize(to_string(type), session_name, std::move(type_samples)));
+    results.push_back(Bench::summarize("session", session_name, std::move(session_samples)));
+
+    printf("%zu calls, %zu distinct file contents\n\n", session->calls.size(), session->contents.size());
+    Bench::print_results(results);
+    if (json_path.has_value()) {
+        FILE* stream = fopen(json_path->c_str(), "w");
+        if (!stream) {
+            fprintf(stderr, "Unable to write %s\n", json_path->c_str());
+            return 1;
+        }
+        Bench::write_json(results, stream);
+        fclose(stream);
+    }
+    return 0;
+}
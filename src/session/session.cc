@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "session.hh"
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+namespace CodeComprehension {
+
+namespace {
+
+constexpr char magic[] = "CCSESSN";
+constexpr uint8_t format_version = 1;
+
+enum class RecordTag : uint8_t {
+    String = 1,
+    Content = 2,
+    FileRead = 3,
+    Call = 4,
+};
+
+#define __SESSION_CALL(x) +1
+constexpr size_t session_call_type_count = 0 FOR_EACH_SESSION_CALL;
+#undef __SESSION_CALL
+
+class SessionReader {
+public:
+    explicit SessionReader(std::string_view data)
+        : m_data(data)
+    {
+    }
+
+    bool at_end() const { return m_offset == m_data.size(); }
+
+    std::optional<uint8_t> read_byte()
+    {
+        if (m_offset >= m_data.size())
+            return {};
+        return static_cast<uint8_t>(m_data[m_offset++]);
+    }
+
+    std::optional<uint64_t> read_varint()
+    {
+        uint64_t value = 0;
+        for (size_t shift = 0; shift < 64; shift += 7) {
+            auto byte = read_byte();
+            if (!byte.has_value())
+                return {};
+            value |= static_cast<uint64_t>(*byte & 0x7f) << shift;
+            if (!(*byte & 0x80))
+                return value;
+        }
+        return {};
+    }
+
+    std::optional<uint64_t> read_hash()
+    {
+        if (m_data.size() - m_offset < 8)
+            return {};
+        uint64_t hash = 0;
+        for (size_t i = 0; i < 8; ++i)
+            hash |= static_cast<uint64_t>(static_cast<uint8_t>(m_data[m_offset + i])) << (8 * i);
+        m_offset += 8;
+        return hash;
+    }
+
+    std::optional<std::string_view> read_string()
+    {
+        auto length = read_varint();
+        if (!length.has_value() || *length > m_data.size() - m_offset)
+            return {};
+        auto string = m_data.substr(m_offset, *length);
+        m_offset += *length;
+        return string;
+    }
+
+private:
+    std::string_view m_data;
+    size_t m_offset { 0 };
+};
+
+}
+
+char const* to_string(SessionCallType type)
+{
+    switch (type) {
+#define __SESSION_CALL(x)       \
+    case SessionCallType::x:    \
+        return #x;
+        FOR_EACH_SESSION_CALL
+#undef __SESSION_CALL
+    }
+    return "";
+}
+
+uint64_t content_hash(std::string_view content)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    for (auto character : content) {
+        hash ^= static_cast<uint8_t>(character);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+SessionWriter::SessionWriter(std::ofstream&& stream)
+    : m_stream(std::move(stream))
+{
+}
+
+std::unique_ptr<SessionWriter> SessionWriter::create(std::string const& path, std::optional<std::string> const& project_root, std::string* error)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        if (error)
+            *error = std::string { "unable to create " } + path + ": " + strerror(errno);
+        return nullptr;
+    }
+
+    std::unique_ptr<SessionWriter> writer(new SessionWriter(std::move(stream)));
+    writer->m_stream.write(magic, sizeof(magic) - 1);
+    writer->m_stream.put(static_cast<char>(format_version));
+    writer->m_stream.put(project_root.has_value() ? 1 : 0);
+    if (project_root.has_value())
+        writer->write_string(*project_root);
+    return writer;
+}
+
+void SessionWriter::write_varint(uint64_t value)
+{
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        m_stream.put(static_cast<char>(value ? byte | 0x80 : byte));
+    } while (value);
+}
+
+void SessionWriter::write_string(std::string_view string)
+{
+    write_varint(string.size());
+    m_stream.write(string.data(), static_cast<std::streamsize>(string.size()));
+}
+
+uint64_t SessionWriter::id_of_string(std::string_view string)
+{
+    if (auto it = m_string_ids.find(std::string { string }); it != m_string_ids.end())
+        return it->second;
+    auto id = m_string_ids.size();
+    m_string_ids.emplace(string, id);
+    m_stream.put(static_cast<char>(RecordTag::String));
+    write_string(string);
+    return id;
+}
+
+void SessionWriter::write_call(SessionCallType type, std::string const& file, GUI::TextPosition position, uint64_t number)
+{
+    auto file_id = id_of_string(type == SessionCallType::SetMemoryBudget ? std::string_view {} : std::string_view { file });
+    m_stream.put(static_cast<char>(RecordTag::Call));
+    m_stream.put(static_cast<char>(type));
+    write_varint(file_id);
+    write_varint(position.line());
+    write_varint(position.column());
+    write_varint(number);
+}
+
+void SessionWriter::write_file_read(std::string_view filename, std::optional<std::string> const& content)
+{
+    auto filename_id = id_of_string(filename);
+    std::optional<uint64_t> hash;
+    if (content.has_value()) {
+        hash = content_hash(*content);
+        if (m_written_contents.insert(*hash).second) {
+            m_stream.put(static_cast<char>(RecordTag::Content));
+            for (size_t i = 0; i < 8; ++i)
+                m_stream.put(static_cast<char>((*hash >> (8 * i)) & 0xff));
+            write_string(*content);
+        }
+    }
+
+    m_stream.put(static_cast<char>(RecordTag::FileRead));
+    write_varint(filename_id);
+    m_stream.put(hash.has_value() ? 1 : 0);
+    if (hash.has_value()) {
+        for (size_t i = 0; i < 8; ++i)
+            m_stream.put(static_cast<char>((*hash >> (8 * i)) & 0xff));
+    }
+}
+
+std::optional<Session> read_session(std::string const& path, std::string* error)
+{
+    auto fail = [&](std::string reason) -> std::optional<Session> {
+        if (error)
+            *error = std::move(reason);
+        return {};
+    };
+
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+        return fail("unable to open " + path);
+    std::string data { std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+
+    constexpr size_t magic_length = sizeof(magic) - 1;
+    if (data.size() < magic_length + 2 || data.compare(0, magic_length, magic) != 0)
+        return fail(path + " is not a session");
+    if (static_cast<uint8_t>(data[magic_length]) != format_version)
+        return fail(path + " has an unsupported format version");
+
+    SessionReader reader(std::string_view { data }.substr(magic_length + 1));
+    Session session;
+    auto has_project_root = reader.read_byte();
+    if (!has_project_root.has_value())
+        return fail(path + " is truncated");
+    if (*has_project_root) {
+        auto project_root = reader.read_string();
+        if (!project_root.has_value())
+            return fail(path + " is truncated");
+        session.project_root = std::string { *project_root };
+    }
+
+    std::vector<std::string_view> strings;
+    auto read_string_id = [&]() -> std::optional<std::string_view> {
+        auto id = reader.read_varint();
+        if (!id.has_value() || *id >= strings.size())
+            return {};
+        return strings[*id];
+    };
+
+    while (!reader.at_end()) {
+        auto tag = reader.read_byte();
+        switch (static_cast<RecordTag>(*tag)) {
+        case RecordTag::String: {
+            auto string = reader.read_string();
+            if (!string.has_value())
+                return fail(path + " is truncated");
+            strings.push_back(*string);
+            break;
+        }
+        case RecordTag::Content: {
+            auto hash = reader.read_hash();
+            auto content = reader.read_string();
+            if (!hash.has_value() || !content.has_value())
+                return fail(path + " is truncated");
+            session.contents.emplace(*hash, std::string { *content });
+            break;
+        }
+        case RecordTag::FileRead: {
+            auto filename = read_string_id();
+            auto has_content = reader.read_byte();
+            if (!filename.has_value() || !has_content.has_value())
+                return fail(path + " is truncated");
+            SessionFileRead file_read { std::string { *filename }, {} };
+            if (*has_content) {
+                file_read.content_hash = reader.read_hash();
+                if (!file_read.content_hash.has_value() || !session.contents.contains(*file_read.content_hash))
+                    return fail(path + " refers to a missing content");
+            }
+            auto& file_reads = session.calls.empty() ? session.initial_file_reads : session.calls.back().file_reads;
+            file_reads.push_back(std::move(file_read));
+            break;
+        }
+        case RecordTag::Call: {
+            auto type = reader.read_byte();
+            auto file = read_string_id();
+            auto line = reader.read_varint();
+            auto column = reader.read_varint();
+            auto number = reader.read_varint();
+            if (!type.has_value() || !file.has_value() || !line.has_value() || !column.has_value() || !number.has_value())
+                return fail(path + " is truncated");
+            if (*type >= session_call_type_count)
+                return fail(path + " has an unknown call type");
+            session.calls.push_back({ static_cast<SessionCallType>(*type), std::string { *file }, { *line, *column }, *number, {} });
+            break;
+        }
+        default:
+            return fail(path + " has an unknown record");
+        }
+    }
+    return session;
+}
+
+SessionFileDB::SessionFileDB(Session const& session)
+    : m_session(session)
+{
+    if (session.project_root.has_value())
+        set_project_root(*session.project_root);
+    apply(session.initial_file_reads);
+}
+
+void SessionFileDB::apply(std::vector<SessionFileRead> const& file_reads)
+{
+    for (auto const& file_read : file_reads)
+        m_content_hashes.insert_or_assign(file_read.filename, file_read.content_hash);
+}
+
+std::optional<std::string> SessionFileDB::get_or_read_from_filesystem(std::string_view filename) const
+{
+    auto it = m_content_hashes.find(std::string { filename });
+    if (it == m_content_hashes.end() || !it->second.has_value())
+        return {};
+    return m_session.contents.at(*it->second);
+}
+
+void replay_call(CodeComprehensionEngine& engine, SessionCall const& call)
+{
+    switch (call.type) {
+    case SessionCallType::GetSuggestions:
+        engine.get_suggestions(call.file, call.position);
+        break;
+    case SessionCallType::OnEdit:
+        engine.on_edit(call.file);
+        break;
+    case SessionCallType::FileOpened:
+        engine.file_opened(call.file);
+        break;
+    case SessionCallType::FileClosed:
+        engine.file_closed(call.file);
+        break;
+    case SessionCallType::IndexDocument:
+        engine.index_document(call.file);
+        break;
+    case SessionCallType::FindDeclarationOf:
+        engine.find_declaration_of(call.file, call.position);
+        break;
+    case SessionCallType::GetFunctionParamsHint:
+        engine.get_function_params_hint(call.file, call.position);
+        break;
+    case SessionCallType::GetTokensInfo:
+        engine.get_tokens_info(call.file);
+        break;
+    case SessionCallType::DocumentOutline:
+        engine.document_outline(call.file);
+        break;
+    case SessionCallType::SetMemoryBudget:
+        engine.set_memory_budget(call.number);
+        break;
+    case SessionCallType::SearchWorkspaceSymbols:
+        engine.search_workspace_symbols(call.file, call.number);
+        break;
+    }
+}
+
+}
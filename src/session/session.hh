@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "codecomprehensionengine.hh"
+#include "filedb.hh"
+
+// A session is the sequence of calls an editor made to an engine, together with the file contents the engine read
+// while handling them. Sessions are recorded with a RecordingEngine and can be replayed against any engine build.
+//
+// The file format is a magic, the project root, and a stream of records:
+//   String:   a filename, referred to by its index from then on
+//   Content:  the content of a file, stored once per distinct content (keyed by content_hash())
+//   FileRead: a filename and the hash of the content it had, or none if the file couldn't be read
+//   Call:     the type of the call, its file and position, and a number (the memory budget, or the limit of a
+//             workspace symbol search, whose query is stored in place of the file)
+// File reads belong to the call before them, the ones before the first call belong to no call.
+// Integers are LEB128 varints, except for the hashes which are 8 bytes in little endian.
+
+namespace CodeComprehension {
+
+#define FOR_EACH_SESSION_CALL                  \
+    __SESSION_CALL(GetSuggestions)             \
+    __SESSION_CALL(OnEdit)                     \
+    __SESSION_CALL(FileOpened)                 \
+    __SESSION_CALL(FileClosed)                 \
+    __SESSION_CALL(IndexDocument)              \
+    __SESSION_CALL(FindDeclarationOf)          \
+    __SESSION_CALL(GetFunctionParamsHint)      \
+    __SESSION_CALL(GetTokensInfo)              \
+    __SESSION_CALL(DocumentOutline)            \
+    __SESSION_CALL(SetMemoryBudget)            \
+    __SESSION_CALL(SearchWorkspaceSymbols)
+
+enum class SessionCallType : uint8_t {
+#define __SESSION_CALL(x) x,
+    FOR_EACH_SESSION_CALL
+#undef __SESSION_CALL
+};
+
+char const* to_string(SessionCallType);
+
+struct SessionFileRead {
+    std::string filename;
+    // Empty if the file couldn't be read.
+    std::optional<uint64_t> content_hash;
+};
+
+struct SessionCall {
+    SessionCallType type { SessionCallType::GetSuggestions };
+    // The query of SearchWorkspaceSymbols.
+    std::string file;
+    GUI::TextPosition position { 0, 0 };
+    // The budget of SetMemoryBudget, or the limit of SearchWorkspaceSymbols.
+    uint64_t number { 0 };
+    std::vector<SessionFileRead> file_reads;
+};
+
+struct Session {
+    std::optional<std::string> project_root;
+    std::unordered_map<uint64_t, std::string> contents;
+    std::vector<SessionFileRead> initial_file_reads;
+    std::vector<SessionCall> calls;
+};
+
+// FNV-1a, so that hashes are the same across builds and platforms.
+uint64_t content_hash(std::string_view);
+
+class SessionWriter {
+    SessionWriter(SessionWriter const&) = delete;
+    SessionWriter& operator=(SessionWriter const&) = delete;
+
+public:
+    // Returns nullptr if the file can't be created, 'error' (if given) is set to the reason.
+    static std::unique_ptr<SessionWriter> create(std::string const& path, std::optional<std::string> const& project_root, std::string* error = nullptr);
+
+    // 'file' is ignored for SetMemoryBudget, and is the query for SearchWorkspaceSymbols.
+    void write_call(SessionCallType, std::string const& file, GUI::TextPosition position = { 0, 0 }, uint64_t number = 0);
+    void write_file_read(std::string_view filename, std::optional<std::string> const& content);
+
+    // Everything is buffered until then, or until the writer is destroyed.
+    void flush() { m_stream.flush(); }
+
+private:
+    explicit SessionWriter(std::ofstream&&);
+
+    uint64_t id_of_string(std::string_view);
+    void write_varint(uint64_t);
+    void write_string(std::string_view);
+
+    std::ofstream m_stream;
+    std::unordered_map<std::string, uint64_t> m_string_ids;
+    std::unordered_set<uint64_t> m_written_contents;
+};
+
+// Returns an empty optional if the file can't be read or is malformed, 'error' (if given) is set to the reason.
+std::optional<Session> read_session(std::string const& path, std::string* error = nullptr);
+
+// Serves the file contents that were observed during a session, apply() the reads of a call before replaying it.
+// A file keeps the content it was last read with, so an engine that reads more than the recorded one did still sees
+// consistent files.
+class SessionFileDB final : public FileDB {
+public:
+    explicit SessionFileDB(Session const&);
+
+    void apply(std::vector<SessionFileRead> const&);
+
+    virtual std::optional<std::string> get_or_read_from_filesystem(std::string_view filename) const override;
+
+private:
+    Session const& m_session;
+    std::unordered_map<std::string, std::optional<uint64_t>> m_content_hashes;
+};
+
+// Makes the call on the engine and discards its result.
+void replay_call(CodeComprehensionEngine&, SessionCall const&);
+
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "statistics.hh"
+#include <algorithm>
+#include <bit>
+#include <fmt/format.h>
+
+namespace CodeComprehension {
+
+char const* to_string(EngineApi api)
+{
+    switch (api) {
+#define __ENGINE_API(x) \
+    case EngineApi::x:  \
+        return #x;
+        FOR_EACH_ENGINE_API
+#undef __ENGINE_API
+    }
+    return "";
+}
+
+char const* to_string(EngineCounter counter)
+{
+    switch (counter) {
+#define __ENGINE_COUNTER(x)  \
+    case EngineCounter::x:   \
+        return #x;
+        FOR_EACH_ENGINE_COUNTER
+#undef __ENGINE_COUNTER
+    }
+    return "";
+}
+
+size_t LatencyHistogram::bucket_of(uint64_t nanoseconds)
+{
+    if (nanoseconds < sub_buckets_per_octave)
+        return static_cast<size_t>(nanoseconds);
+    // The octave is the position of the highest bit, the sub-bucket is given by the two bits below it.
+    size_t octave = std::bit_width(nanoseconds) - 1;
+    size_t sub_bucket = static_cast<size_t>(nanoseconds >> (octave - 2)) & (sub_buckets_per_octave - 1);
+    return std::min(octave * sub_buckets_per_octave + sub_bucket, bucket_count - 1);
+}
+
+uint64_t LatencyHistogram::upper_bound_of(size_t bucket)
+{
+    // Values below 4 have a bucket each, and nothing lands in the buckets of the second octave.
+    if (bucket < 2 * sub_buckets_per_octave)
+        return std::min<uint64_t>(bucket, sub_buckets_per_octave - 1);
+    size_t octave = bucket / sub_buckets_per_octave;
+    uint64_t sub_bucket = bucket % sub_buckets_per_octave;
+    return ((sub_buckets_per_octave + sub_bucket + 1) << (octave - 2)) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+    auto nanoseconds = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+    m_buckets[bucket_of(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total_nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    auto max = m_max_nanoseconds.load(std::memory_order_relaxed);
+    while (nanoseconds > max && !m_max_nanoseconds.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) { }
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize() const
+{
+    // Concurrent recordings may make the buckets and the totals disagree slightly, which doesn't matter for a summary.
+    std::array<uint64_t, bucket_count> buckets;
+    uint64_t count = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+        buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        count += buckets[i];
+    }
+
+    Summary summary;
+    summary.count = count;
+    if (count == 0)
+        return summary;
+
+    auto max_nanoseconds = m_max_nanoseconds.load(std::memory_order_relaxed);
+    auto to_microseconds = [](uint64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1000.0; };
+    auto percentile = [&](double fraction) {
+        auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(count) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucket_count; ++i) {
+            seen += buckets[i];
+            if (seen >= rank)
+                return to_microseconds(std::min(upper_bound_of(i), max_nanoseconds));
+        }
+        return to_microseconds(max_nanoseconds);
+    };
+
+    summary.mean = to_microseconds(m_total_nanoseconds.load(std::memory_order_relaxed)) / static_cast<double>(std::max<uint64_t>(m_count.load(std::memory_order_relaxed), 1));
+    summary.p50 = percentile(0.50);
+    summary.p90 = percentile(0.90);
+    summary.p99 = percentile(0.99);
+    summary.max = to_microseconds(max_nanoseconds);
+    return summary;
+}
+
+uint64_t Statistics::counter(EngineCounter counter) const
+{
+    for (auto const& entry : counters) {
+        if (entry.counter == counter)
+            return entry.value;
+    }
+    return 0;
+}
+
+double Statistics::include_resolution_hit_rate() const
+{
+    auto hits = counter(EngineCounter::IncludeResolutionHits);
+    auto total = hits + counter(EngineCounter::IncludeResolutionMisses);
+    return total == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(total);
+}
+
+size_t Statistics::total_bytes() const
+{
+    size_t bytes = 0;
+    for (auto const& document : documents)
+        bytes += document.bytes;
+    return bytes;
+}
+
+size_t Statistics::total_symbol_count() const
+{
+    size_t symbol_count = 0;
+    for (auto const& document : documents)
+        symbol_count += document.symbol_count;
+    return symbol_count;
+}
+
+std::string Statistics::to_text() const
+{
+    auto per_call = [](uint64_t total, uint64_t calls) { return calls == 0 ? 0 : total / calls; };
+
+    std::string text;
+    text += fmt::format("{:<24} {:>8} {:>11} {:>11} {:>11} {:>11} {:>11}", "api", "count", "mean (us)", "p50", "p90", "p99", "max");
+    if (Allocations::is_compiled_in)
+        text += fmt::format(" {:>12} {:>12}", "allocs/call", "bytes/call");
+    text += "\n";
+    for (auto const& [api, latency, allocations] : latencies) {
+        text += fmt::format("{:<24} {:>8} {:>11.1f} {:>11.1f} {:>11.1f} {:>11.1f} {:>11.1f}", to_string(api), latency.count, latency.mean, latency.p50, latency.p90, latency.p99, latency.max);
+        if (Allocations::is_compiled_in)
+            text += fmt::format(" {:>12} {:>12}", per_call(allocations.count, latency.count), per_call(allocations.bytes, latency.count));
+        text += "\n";
+    }
+
+    text += "\n";
+    for (auto const& [counter, value] : counters)
+        text += fmt::format("{:<24} {}\n", to_string(counter), value);
+    text += fmt::format("{:<24} {:.3f}\n", "IncludeResolutionHitRate", include_resolution_hit_rate());
+
+    auto evicted_count = std::count_if(documents.begin(), documents.end(), [](auto const& document) { return document.is_evicted; });
+    text += fmt::format("\n{} documents ({} evicted), {} symbols, {} bytes\n", documents.size(), evicted_count, total_symbol_count(), total_bytes());
+    return text;
+}
+
+std::string Statistics::to_json() const
+{
+    auto escape = [](std::string_view string) {
+        std::string escaped;
+        for (auto character : string) {
+            if (character == '"' || character == '\\')
+                escaped += '\\';
+            if (static_cast<unsigned char>(character) >= 0x20)
+                escaped += character;
+        }
+        return escaped;
+    };
+
+    std::string json = "{\"latencies\":{";
+    for (size_t i = 0; i < latencies.size(); ++i) {
+        auto const& [api, latency, allocations] = latencies[i];
+        json += fmt::format("{}\"{}\":{{\"count\":{},\"mean\":{:.3f},\"p50\":{:.3f},\"p90\":{:.3f},\"p99\":{:.3f},\"max\":{:.3f}",
+            i == 0 ? "" : ",", to_string(api), latency.count, latency.mean, latency.p50, latency.p90, latency.p99, latency.max);
+        if (Allocations::is_compiled_in)
+            json += fmt::format(",\"allocations\":{},\"allocated_bytes\":{}", allocations.count, allocations.bytes);
+        json += "}";
+    }
+    json += "},\"counters\":{";
+    for (size_t i = 0; i < counters.size(); ++i)
+        json += fmt::format("{}\"{}\":{}", i == 0 ? "" : ",", to_string(counters[i].counter), counters[i].value);
+    json += fmt::format("}},\"include_resolution_hit_rate\":{:.3f},\"total_bytes\":{},\"total_symbol_count\":{},\"documents\":[", include_resolution_hit_rate(), total_bytes(), total_symbol_count());
+    for (size_t i = 0; i < documents.size(); ++i) {
+        auto const& document = documents[i];
+        json += fmt::format("{}{{\"file\":\"{}\",\"bytes\":{},\"symbol_count\":{},\"is_evicted\":{}}}",
+            i == 0 ? "" : ",", escape(document.file), document.bytes, document.symbol_count, document.is_evicted);
+    }
+    json += "]}";
+    return json;
+}
+
+}
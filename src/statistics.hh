@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "allocationcounter.hh"
+
+namespace CodeComprehension {
+
+#define FOR_EACH_ENGINE_API               \
+    __ENGINE_API(GetSuggestions)          \
+    __ENGINE_API(FindDeclarationOf)       \
+    __ENGINE_API(GetFunctionParamsHint)   \
+    __ENGINE_API(GetTokensInfo)           \
+    __ENGINE_API(DocumentOutline)         \
+    __ENGINE_API(SearchWorkspaceSymbols)  \
+    __ENGINE_API(OnEdit)                  \
+    __ENGINE_API(FileOpened)              \
+    __ENGINE_API(IndexDocument)
+
+#define FOR_EACH_ENGINE_COUNTER             \
+    __ENGINE_COUNTER(Parses)                \
+    __ENGINE_COUNTER(Reparses)              \
+    __ENGINE_COUNTER(Rehydrations)          \
+    __ENGINE_COUNTER(Evictions)             \
+    __ENGINE_COUNTER(SymbolTableBuilds)     \
+    __ENGINE_COUNTER(IncludeResolutionHits) \
+    __ENGINE_COUNTER(IncludeResolutionMisses)
+
+enum class EngineApi {
+#define __ENGINE_API(x) x,
+    FOR_EACH_ENGINE_API
+#undef __ENGINE_API
+};
+
+enum class EngineCounter {
+#define __ENGINE_COUNTER(x) x,
+    FOR_EACH_ENGINE_COUNTER
+#undef __ENGINE_COUNTER
+};
+
+char const* to_string(EngineApi);
+char const* to_string(EngineCounter);
+
+// A histogram of durations with four buckets per power of two nanoseconds, so percentiles are within 19% of the real value.
+// Recording is lock-free and can happen concurrently with other recordings and with summarize().
+class LatencyHistogram {
+public:
+    struct Summary {
+        uint64_t count { 0 };
+        // In microseconds. Percentiles are the upper bounds of their buckets, capped at the maximum.
+        double mean { 0 };
+        double p50 { 0 };
+        double p90 { 0 };
+        double p99 { 0 };
+        double max { 0 };
+    };
+
+    void record(std::chrono::nanoseconds);
+    Summary summarize() const;
+
+private:
+    static constexpr size_t sub_buckets_per_octave = 4;
+    static constexpr size_t bucket_count = 64 * sub_buckets_per_octave;
+
+    static size_t bucket_of(uint64_t nanoseconds);
+    static uint64_t upper_bound_of(size_t bucket);
+
+    std::array<std::atomic<uint64_t>, bucket_count> m_buckets {};
+    std::atomic<uint64_t> m_count { 0 };
+    std::atomic<uint64_t> m_total_nanoseconds { 0 };
+    std::atomic<uint64_t> m_max_nanoseconds { 0 };
+};
+
+// Sums of allocation counts that can be added to concurrently.
+class AtomicAllocationCounts {
+public:
+    void record(AllocationCounts counts)
+    {
+        m_count.fetch_add(counts.count, std::memory_order_relaxed);
+        m_bytes.fetch_add(counts.bytes, std::memory_order_relaxed);
+    }
+    AllocationCounts load() const { return { m_count.load(std::memory_order_relaxed), m_bytes.load(std::memory_order_relaxed) }; }
+
+private:
+    std::atomic<uint64_t> m_count { 0 };
+    std::atomic<uint64_t> m_bytes { 0 };
+};
+
+// What an engine records about itself while it runs.
+// Recording and reading can happen on different threads, every histogram and counter is atomic on its own.
+class EngineStatistics {
+public:
+    class ScopedTimer {
+        ScopedTimer(ScopedTimer const&) = delete;
+        ScopedTimer& operator=(ScopedTimer const&) = delete;
+
+    public:
+        ScopedTimer(LatencyHistogram& histogram, AtomicAllocationCounts& allocations)
+            : m_histogram(histogram)
+            , m_allocations(allocations)
+            , m_start_allocations(Allocations::of_current_thread())
+            , m_start(std::chrono::steady_clock::now())
+        {
+        }
+        ~ScopedTimer()
+        {
+            m_histogram.record(std::chrono::steady_clock::now() - m_start);
+            if constexpr (Allocations::is_compiled_in)
+                m_allocations.record(Allocations::of_current_thread() - m_start_allocations);
+        }
+
+    private:
+        LatencyHistogram& m_histogram;
+        AtomicAllocationCounts& m_allocations;
+        AllocationCounts m_start_allocations;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // Records the duration (and the allocations, see allocationcounter.hh) of the enclosing scope,
+    // e.g "auto timer = statistics.time(EngineApi::GetSuggestions);"
+    [[nodiscard]] ScopedTimer time(EngineApi api) { return ScopedTimer(m_latencies[static_cast<size_t>(api)], m_allocations[static_cast<size_t>(api)]); }
+
+    void increment(EngineCounter counter, uint64_t amount = 1) { m_counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed); }
+
+    LatencyHistogram const& latency_of(EngineApi api) const { return m_latencies[static_cast<size_t>(api)]; }
+    AllocationCounts allocations_of(EngineApi api) const { return m_allocations[static_cast<size_t>(api)].load(); }
+    uint64_t counter(EngineCounter counter) const { return m_counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed); }
+
+private:
+#define __ENGINE_API(x) +1
+    static constexpr size_t api_count = 0 FOR_EACH_ENGINE_API;
+#undef __ENGINE_API
+#define __ENGINE_COUNTER(x) +1
+    static constexpr size_t counter_count = 0 FOR_EACH_ENGINE_COUNTER;
+#undef __ENGINE_COUNTER
+
+    std::array<LatencyHistogram, api_count> m_latencies;
+    std::array<AtomicAllocationCounts, api_count> m_allocations;
+    std::array<std::atomic<uint64_t>, counter_count> m_counters {};
+};
+
+// A snapshot of the statistics of an engine, see CodeComprehensionEngine::statistics().
+// The latencies and counters come from EngineStatistics, the documents are taken from the engine itself.
+struct Statistics {
+    struct ApiLatency {
+        EngineApi api;
+        LatencyHistogram::Summary latency;
+        // Summed up over all calls, always zero unless Allocations::is_compiled_in.
+        AllocationCounts allocations;
+    };
+    struct Counter {
+        EngineCounter counter;
+        uint64_t value { 0 };
+    };
+    struct Document {
+        std::string file;
+        size_t bytes { 0 };
+        size_t symbol_count { 0 };
+        bool is_evicted { false };
+    };
+
+    std::vector<ApiLatency> latencies;
+    std::vector<Counter> counters;
+    std::vector<Document> documents;
+
+    uint64_t counter(EngineCounter) const;
+    // Between 0 and 1, or 0 if no include was resolved yet.
+    double include_resolution_hit_rate() const;
+    size_t total_bytes() const;
+    size_t total_symbol_count() const;
+
+    std::string to_text() const;
+    std::string to_json() const;
+};
+
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "symbolsearchindex.hh"
+#include <algorithm>
+#include <cctype>
+#include <optional>
+
+namespace CodeComprehension {
+
+std::string SymbolSearchIndex::to_lowercase(std::string_view text)
+{
+    std::string lowercase_text { text };
+    for (auto& ch : lowercase_text)
+        ch = static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+    return lowercase_text;
+}
+
+std::vector<SymbolSearchIndex::Trigram> SymbolSearchIndex::trigrams_of(std::string_view lowercase_text)
+{
+    std::vector<Trigram> trigrams;
+    if (lowercase_text.length() < 3)
+        return trigrams;
+
+    for (size_t i = 0; i + 3 <= lowercase_text.length(); ++i) {
+        trigrams.push_back(static_cast<Trigram>(static_cast<unsigned char>(lowercase_text[i])) << 16
+            | static_cast<Trigram>(static_cast<unsigned char>(lowercase_text[i + 1])) << 8
+            | static_cast<Trigram>(static_cast<unsigned char>(lowercase_text[i + 2])));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+uint64_t SymbolSearchIndex::character_mask_of(std::string_view lowercase_text)
+{
+    uint64_t mask = 0;
+    for (auto ch : lowercase_text)
+        mask |= uint64_t { 1 } << (static_cast<unsigned char>(ch) % 64);
+    return mask;
+}
+
+void SymbolSearchIndex::set_declarations_of_document(std::string const& filename, std::vector<Declaration> const& declarations)
+{
+    if (auto it = m_entries_of_documents.find(filename); it != m_entries_of_documents.end()) {
+        auto& entry_ids = it->second;
+        bool is_unchanged = entry_ids.size() == declarations.size();
+        for (size_t i = 0; is_unchanged && i < entry_ids.size(); ++i)
+            is_unchanged = m_entries[entry_ids[i]].declaration == declarations[i];
+        if (is_unchanged)
+            return;
+    }
+
+    remove_document(filename);
+
+    std::vector<EntryId> entry_ids;
+    entry_ids.reserve(declarations.size());
+    for (auto& declaration : declarations)
+        entry_ids.push_back(add_entry(declaration));
+    m_entries_of_documents.emplace(filename, move(entry_ids));
+}
+
+void SymbolSearchIndex::remove_document(std::string const& filename)
+{
+    auto it = m_entries_of_documents.find(filename);
+    if (it == m_entries_of_documents.end())
+        return;
+    for (auto entry_id : it->second)
+        remove_entry(entry_id);
+    m_entries_of_documents.erase(it);
+}
+
+SymbolSearchIndex::EntryId SymbolSearchIndex::add_entry(Declaration const& declaration)
+{
+    EntryId entry_id;
+    if (!m_free_entries.empty()) {
+        entry_id = m_free_entries.back();
+        m_free_entries.pop_back();
+    } else {
+        entry_id = static_cast<EntryId>(m_entries.size());
+        m_entries.emplace_back();
+    }
+
+    auto& entry = m_entries[entry_id];
+    entry.declaration = declaration;
+    entry.lowercase_name = to_lowercase(declaration.name);
+    entry.trigrams = trigrams_of(entry.lowercase_name);
+    entry.character_mask = character_mask_of(entry.lowercase_name);
+    entry.is_alive = true;
+
+    entry.posting_positions.reserve(entry.trigrams.size());
+    for (auto trigram : entry.trigrams) {
+        auto& entry_ids = m_postings[trigram];
+        entry.posting_positions.push_back(static_cast<uint32_t>(entry_ids.size()));
+        entry_ids.push_back(entry_id);
+    }
+    return entry_id;
+}
+
+void SymbolSearchIndex::remove_entry(EntryId entry_id)
+{
+    auto& entry = m_entries[entry_id];
+    for (size_t i = 0; i < entry.trigrams.size(); ++i) {
+        auto postings = m_postings.find(entry.trigrams[i]);
+        auto& entry_ids = postings->second;
+        auto position = entry.posting_positions[i];
+
+        // Move the last entry of the list into our place, and tell it where it is now.
+        auto moved_entry_id = entry_ids.back();
+        entry_ids[position] = moved_entry_id;
+        entry_ids.pop_back();
+        if (moved_entry_id != entry_id) {
+            auto& moved_entry = m_entries[moved_entry_id];
+            auto it = std::lower_bound(moved_entry.trigrams.begin(), moved_entry.trigrams.end(), entry.trigrams[i]);
+            moved_entry.posting_positions[static_cast<size_t>(it - moved_entry.trigrams.begin())] = position;
+        }
+        if (entry_ids.empty())
+            m_postings.erase(postings);
+    }
+
+    entry = {};
+    m_free_entries.push_back(entry_id);
+}
+
+int SymbolSearchIndex::fuzzy_match_score(std::string_view query, std::string_view name)
+{
+    if (query.empty())
+        return 0;
+
+    auto is_word_start = [&](size_t index) {
+        if (index == 0)
+            return true;
+        auto previous = name[index - 1];
+        if (previous == '_' || previous == ':')
+            return true;
+        return islower(static_cast<unsigned char>(previous)) && isupper(static_cast<unsigned char>(name[index]));
+    };
+
+    int score = 0;
+    size_t name_index = 0;
+    std::optional<size_t> previous_match;
+    for (auto query_char : query) {
+        auto lowercase_query_char = tolower(static_cast<unsigned char>(query_char));
+        while (name_index < name.length() && tolower(static_cast<unsigned char>(name[name_index])) != lowercase_query_char)
+            ++name_index;
+        if (name_index == name.length())
+            return -1;
+
+        score += 1;
+        if (previous_match.has_value() && previous_match.value() + 1 == name_index)
+            score += 5;
+        if (is_word_start(name_index))
+            score += 10;
+        if (name[name_index] == query_char)
+            score += 1;
+
+        previous_match = name_index;
+        ++name_index;
+    }
+
+    auto is_case_insensitive_prefix = std::equal(query.begin(), query.end(), name.begin(), [](char a, char b) {
+        return tolower(static_cast<unsigned char>(a)) == tolower(static_cast<unsigned char>(b));
+    });
+    if (name.length() == query.length())
+        score += 100;
+    else if (is_case_insensitive_prefix)
+        score += 50;
+
+    // Prefer shorter names among equally good matches.
+    score -= static_cast<int>(std::min<size_t>(name.length() - query.length(), 20));
+    return score;
+}
+
+std::vector<Declaration> SymbolSearchIndex::search(std::string_view query, size_t limit) const
+{
+    if (query.empty() || limit == 0)
+        return {};
+
+    auto lowercase_query = to_lowercase(query);
+    auto query_trigrams = trigrams_of(lowercase_query);
+    auto query_character_mask = character_mask_of(lowercase_query);
+
+    struct Candidate {
+        EntryId entry_id;
+        int score;
+    };
+    std::vector<Candidate> candidates;
+
+    auto consider = [&](EntryId entry_id) {
+        auto const& entry = m_entries[entry_id];
+        if (!entry.is_alive || (entry.character_mask & query_character_mask) != query_character_mask)
+            return;
+        auto score = fuzzy_match_score(query, entry.declaration.name);
+        if (score >= 0)
+            candidates.push_back({ entry_id, score });
+    };
+
+    if (query_trigrams.empty()) {
+        // Short queries have no trigrams, any name may match them.
+        for (EntryId entry_id = 0; entry_id < m_entries.size(); ++entry_id)
+            consider(entry_id);
+    } else {
+        // The candidates are the names that share a trigram with the query, whether the others would match doesn't depend on 'limit'.
+        std::vector<bool> is_considered(m_entries.size());
+        for (auto trigram : query_trigrams) {
+            auto postings = m_postings.find(trigram);
+            if (postings == m_postings.end())
+                continue;
+            for (auto entry_id : postings->second) {
+                if (is_considered[entry_id])
+                    continue;
+                is_considered[entry_id] = true;
+                consider(entry_id);
+            }
+        }
+    }
+
+    auto is_better = [&](Candidate const& a, Candidate const& b) {
+        if (a.score != b.score)
+            return a.score > b.score;
+        auto const& a_name = m_entries[a.entry_id].declaration.name;
+        auto const& b_name = m_entries[b.entry_id].declaration.name;
+        if (a_name != b_name)
+            return a_name < b_name;
+        return a.entry_id < b.entry_id;
+    };
+
+    auto result_size = std::min(limit, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + result_size, candidates.end(), is_better);
+
+    std::vector<Declaration> results;
+    results.reserve(result_size);
+    for (size_t i = 0; i < result_size; ++i)
+        results.push_back(m_entries[candidates[i].entry_id].declaration);
+    return results;
+}
+
+}
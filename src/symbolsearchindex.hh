@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "types.hh"
+
+namespace CodeComprehension {
+
+// Fuzzy search over the declarations of every document in the project.
+//
+// Candidates are found through trigram postings of the lowercased declaration names
+// and are then ranked by how well the query matches the name as a subsequence.
+// Only queries shorter than a trigram look at every name, a longer query has to share a trigram with a name to find it
+// (e.g "anfoo" finds "another_foo" through "foo", but "gsg" doesn't find "get_suggestions").
+class SymbolSearchIndex {
+public:
+    void set_declarations_of_document(std::string const& filename, std::vector<Declaration> const&);
+    void remove_document(std::string const& filename);
+
+    std::vector<Declaration> search(std::string_view query, size_t limit) const;
+
+    size_t size() const { return m_entries.size() - m_free_entries.size(); }
+
+    // Returns a negative score if 'query' is not a (case-insensitive) subsequence of 'name'.
+    static int fuzzy_match_score(std::string_view query, std::string_view name);
+
+private:
+    using EntryId = uint32_t;
+    using Trigram = uint32_t;
+
+    struct Entry {
+        Declaration declaration;
+        std::string lowercase_name;
+        // Sorted, and where in the posting list of each trigram this entry is, so that it's removed without a search.
+        std::vector<Trigram> trigrams;
+        std::vector<uint32_t> posting_positions;
+        // See character_mask_of(), a name can only match a query whose characters are a subset of its own.
+        uint64_t character_mask { 0 };
+        bool is_alive { false };
+    };
+
+    static std::string to_lowercase(std::string_view);
+    static std::vector<Trigram> trigrams_of(std::string_view lowercase_text);
+    // One bit per lowercase character, characters share bits modulo 64.
+    static uint64_t character_mask_of(std::string_view lowercase_text);
+
+    EntryId add_entry(Declaration const&);
+    void remove_entry(EntryId);
+
+    std::vector<Entry> m_entries;
+    std::vector<EntryId> m_free_entries;
+    std::unordered_map<std::string, std::vector<EntryId>> m_entries_of_documents;
+    std::unordered_map<Trigram, std::vector<EntryId>> m_postings;
+};
+
+}
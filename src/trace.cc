@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "trace.hh"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace CodeComprehension::Trace {
+
+namespace {
+
+struct Event {
+    char const* name { nullptr };
+    // Microseconds since the recording started.
+    double start { 0 };
+    double duration { 0 };
+    std::vector<std::pair<char const*, std::string>> args;
+};
+
+// Every thread appends to its own buffer, the lock is only contended while the trace is written.
+struct ThreadBuffer {
+    uint32_t thread_id { 0 };
+    std::mutex lock;
+    std::vector<Event> events;
+    // Keyed by the address of the span's name.
+    std::unordered_map<char const*, HardwareEventTotals> hardware_event_totals;
+    // Opened the first time this thread counts hardware events, stays null if that fails.
+    std::unique_ptr<PerfCounters> counters;
+    bool has_tried_to_open_counters { false };
+    std::unordered_map<char const*, AllocationTotals> allocation_totals;
+};
+
+std::atomic<bool> s_is_recording { false };
+std::atomic<bool> s_is_counting_hardware_events { false };
+std::atomic<bool> s_is_counting_allocations { false };
+std::chrono::steady_clock::time_point s_recording_start;
+
+std::mutex s_buffers_lock;
+std::vector<std::shared_ptr<ThreadBuffer>> s_buffers;
+
+ThreadBuffer& buffer_of_current_thread()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        std::lock_guard guard(s_buffers_lock);
+        auto new_buffer = std::make_shared<ThreadBuffer>();
+        new_buffer->thread_id = static_cast<uint32_t>(s_buffers.size() + 1);
+        s_buffers.push_back(new_buffer);
+        return new_buffer;
+    }();
+    return *buffer;
+}
+
+void write_json_string(std::ostream& stream, std::string_view string)
+{
+    stream << '"';
+    for (auto character : string) {
+        switch (character) {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '\n':
+            stream << "\\n";
+            break;
+        default:
+            if (static_cast<unsigned char>(character) >= 0x20)
+                stream << character;
+        }
+    }
+    stream << '"';
+}
+
+}
+
+void start_recording()
+{
+    clear();
+    s_recording_start = std::chrono::steady_clock::now();
+    s_is_recording.store(true, std::memory_order_release);
+}
+
+void stop_recording()
+{
+    s_is_recording.store(false, std::memory_order_release);
+}
+
+bool is_recording()
+{
+    return s_is_recording.load(std::memory_order_acquire);
+}
+
+void clear()
+{
+    std::lock_guard guard(s_buffers_lock);
+    for (auto& buffer : s_buffers) {
+        std::lock_guard buffer_guard(buffer->lock);
+        buffer->events.clear();
+    }
+}
+
+void write_chrome_trace(std::ostream& stream)
+{
+    std::lock_guard guard(s_buffers_lock);
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool is_first = true;
+    for (auto& buffer : s_buffers) {
+        std::lock_guard buffer_guard(buffer->lock);
+        for (auto const& event : buffer->events) {
+            stream << (is_first ? "\n" : ",\n");
+            is_first = false;
+            stream << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << ",\"name\":";
+            write_json_string(stream, event.name);
+            stream << ",\"args\":{";
+            for (size_t i = 0; i < event.args.size(); ++i) {
+                if (i != 0)
+                    stream << ',';
+                write_json_string(stream, event.args[i].first);
+                stream << ':';
+                write_json_string(stream, event.args[i].second);
+            }
+            stream << "}}";
+        }
+    }
+    stream << "\n]}\n";
+}
+
+void start_counting_hardware_events()
+{
+    std::lock_guard guard(s_buffers_lock);
+    for (auto& buffer : s_buffers) {
+        std::lock_guard buffer_guard(buffer->lock);
+        buffer->hardware_event_totals.clear();
+    }
+    s_is_counting_hardware_events.store(true, std::memory_order_release);
+}
+
+void stop_counting_hardware_events()
+{
+    s_is_counting_hardware_events.store(false, std::memory_order_release);
+}
+
+std::vector<HardwareEventTotals> hardware_event_totals()
+{
+    std::unordered_map<std::string_view, HardwareEventTotals> totals_by_name;
+    {
+        std::lock_guard guard(s_buffers_lock);
+        for (auto& buffer : s_buffers) {
+            std::lock_guard buffer_guard(buffer->lock);
+            for (auto const& [name, totals] : buffer->hardware_event_totals) {
+                auto& merged_totals = totals_by_name[name];
+                merged_totals.name = name;
+                merged_totals.calls += totals.calls;
+                merged_totals.counts += totals.counts;
+            }
+        }
+    }
+
+    std::vector<HardwareEventTotals> totals;
+    for (auto& [name, name_totals] : totals_by_name)
+        totals.push_back(name_totals);
+    std::sort(totals.begin(), totals.end(), [](auto const& a, auto const& b) { return a.counts.cycles > b.counts.cycles; });
+    return totals;
+}
+
+void start_counting_allocations()
+{
+    std::lock_guard guard(s_buffers_lock);
+    for (auto& buffer : s_buffers) {
+        std::lock_guard buffer_guard(buffer->lock);
+        buffer->allocation_totals.clear();
+    }
+    s_is_counting_allocations.store(Allocations::is_compiled_in, std::memory_order_release);
+}
+
+void stop_counting_allocations()
+{
+    s_is_counting_allocations.store(false, std::memory_order_release);
+}
+
+std::vector<AllocationTotals> allocation_totals()
+{
+    std::unordered_map<std::string_view, AllocationTotals> totals_by_name;
+    {
+        std::lock_guard guard(s_buffers_lock);
+        for (auto& buffer : s_buffers) {
+            std::lock_guard buffer_guard(buffer->lock);
+            for (auto const& [name, totals] : buffer->allocation_totals) {
+                auto& merged_totals = totals_by_name[name];
+                merged_totals.name = name;
+                merged_totals.calls += totals.calls;
+                merged_totals.counts += totals.counts;
+            }
+        }
+    }
+
+    std::vector<AllocationTotals> totals;
+    for (auto& [name, name_totals] : totals_by_name)
+        totals.push_back(name_totals);
+    std::sort(totals.begin(), totals.end(), [](auto const& a, auto const& b) { return a.counts.bytes > b.counts.bytes; });
+    return totals;
+}
+
+bool write_chrome_trace(std::string const& path)
+{
+    std::ofstream stream(path);
+    if (!stream)
+        return false;
+    write_chrome_trace(stream);
+    return static_cast<bool>(stream);
+}
+
+Span::Span(char const* name)
+    : m_name(name)
+    , m_is_recording(Trace::is_recording())
+{
+    if (s_is_counting_hardware_events.load(std::memory_order_acquire)) {
+        auto& buffer = buffer_of_current_thread();
+        if (!buffer.has_tried_to_open_counters) {
+            buffer.has_tried_to_open_counters = true;
+            buffer.counters = PerfCounters::create();
+        }
+        m_counters = buffer.counters.get();
+        if (m_counters)
+            m_start_counts = m_counters->read();
+    }
+    m_is_counting_allocations = s_is_counting_allocations.load(std::memory_order_acquire);
+    if constexpr (Allocations::is_compiled_in)
+        m_start_allocations = Allocations::of_current_thread();
+    if (m_is_recording)
+        m_start = std::chrono::steady_clock::now();
+}
+
+Span::~Span()
+{
+    if (!m_is_recording && !m_counters && !m_is_counting_allocations)
+        return;
+    auto end = std::chrono::steady_clock::now();
+    auto allocations = Allocations::of_current_thread() - m_start_allocations;
+    auto& buffer = buffer_of_current_thread();
+
+    if (m_counters) {
+        auto counts = m_counters->read() - m_start_counts;
+        std::lock_guard guard(buffer.lock);
+        auto& totals = buffer.hardware_event_totals[m_name];
+        totals.name = m_name;
+        ++totals.calls;
+        totals.counts += counts;
+    }
+
+    if (m_is_counting_allocations) {
+        std::lock_guard guard(buffer.lock);
+        auto& totals = buffer.allocation_totals[m_name];
+        totals.name = m_name;
+        ++totals.calls;
+        totals.counts += allocations;
+    }
+
+    if (!m_is_recording)
+        return;
+    if constexpr (Allocations::is_compiled_in) {
+        set_arg("allocations", allocations.count);
+        set_arg("allocated_bytes", allocations.bytes);
+    }
+    std::lock_guard guard(buffer.lock);
+    buffer.events.push_back({
+        m_name,
+        std::chrono::duration<double, std::micro>(m_start - s_recording_start).count(),
+        std::chrono::duration<double, std::micro>(end - m_start).count(),
+        std::move(m_args),
+    });
+}
+
+void Span::set_arg(char const* key, std::string value)
+{
+    if (m_is_recording)
+        m_args.emplace_back(key, std::move(value));
+}
+
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "allocationcounter.hh"
+#include "perfcounters.hh"
+
+// Scoped spans that can be exported as Chrome trace events (chrome://tracing, Perfetto).
+//
+// The TRACE_* macros compile to nothing unless CODE_COMPREHENSION_TRACING is defined (see the
+// CODE_COMPREHENSION_TRACING CMake option), and their arguments aren't evaluated then.
+// When tracing is compiled in, spans are only recorded between Trace::start_recording() and Trace::stop_recording(),
+// and hardware events are only counted between Trace::start_counting_hardware_events() and Trace::stop_counting_hardware_events().
+// If allocation accounting is compiled in as well, recorded spans carry the allocations made during them as arguments.
+// The values of TRACE_ARG are only evaluated if the span is recorded, so they may be expensive to compute.
+//
+//     TRACE_SCOPE("parse");
+//
+//     TRACE_SCOPE_WITH(span, "create_document_data");
+//     TRACE_ARG(span, "file", filename);
+//     TRACE_ARG(span, "bytes", text.size());
+
+namespace CodeComprehension::Trace {
+
+#ifdef CODE_COMPREHENSION_TRACING
+constexpr bool is_compiled_in = true;
+#else
+constexpr bool is_compiled_in = false;
+#endif
+
+void start_recording();
+void stop_recording();
+bool is_recording();
+
+// Drops every recorded event.
+void clear();
+
+// Writes the events of all threads in the trace-event format. Spans that are still open aren't included.
+void write_chrome_trace(std::ostream&);
+bool write_chrome_trace(std::string const& path);
+
+// Attributes hardware events (see PerfCounters) to spans, summed up by span name.
+// Counts include the events of nested spans. Threads whose counters can't be opened don't contribute.
+// Every span reads the counters twice, that's one read() syscall each (a few thousand cycles), and the reads of
+// nested spans are counted in the enclosing ones. Spans around very little work mostly measure themselves.
+void start_counting_hardware_events();
+void stop_counting_hardware_events();
+
+struct HardwareEventTotals {
+    char const* name { nullptr };
+    uint64_t calls { 0 };
+    HardwareEventCounts counts;
+};
+// Sorted by cycles, most first.
+std::vector<HardwareEventTotals> hardware_event_totals();
+
+// Attributes heap allocations to spans, summed up by span name, like the hardware events above.
+// Nothing is counted unless Allocations::is_compiled_in.
+void start_counting_allocations();
+void stop_counting_allocations();
+
+struct AllocationTotals {
+    char const* name { nullptr };
+    uint64_t calls { 0 };
+    AllocationCounts counts;
+};
+// Sorted by allocated bytes, most first.
+std::vector<AllocationTotals> allocation_totals();
+
+class Span {
+    Span(Span const&) = delete;
+    Span& operator=(Span const&) = delete;
+
+public:
+    // 'name' has to outlive the recording, i.e it should be a string literal.
+    explicit Span(char const* name);
+    ~Span();
+
+    bool is_recording() const { return m_is_recording; }
+
+    void set_arg(char const* key, std::string value);
+    void set_arg(char const* key, size_t value) { set_arg(key, std::to_string(value)); }
+
+private:
+    char const* m_name { nullptr };
+    bool m_is_recording { false };
+    std::chrono::steady_clock::time_point m_start;
+    PerfCounters const* m_counters { nullptr };
+    HardwareEventCounts m_start_counts;
+    bool m_is_counting_allocations { false };
+    AllocationCounts m_start_allocations;
+    std::vector<std::pair<char const*, std::string>> m_args;
+};
+
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#ifdef CODE_COMPREHENSION_TRACING
+#    define TRACE_SCOPE(name) ::CodeComprehension::Trace::Span TRACE_CONCAT(trace_span_, __LINE__)(name)
+#    define TRACE_SCOPE_WITH(span, name) ::CodeComprehension::Trace::Span span(name)
+#    define TRACE_ARG(span, key, value)     \
+        do {                                \
+            if ((span).is_recording())      \
+                (span).set_arg(key, value); \
+        } while (0)
+#else
+#    define TRACE_SCOPE(name)
+#    define TRACE_SCOPE_WITH(span, name)
+#    define TRACE_ARG(span, key, value)
+#endif
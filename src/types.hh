@@ -7,6 +7,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <cassert>
 
 namespace CodeComprehension {
@@ -63,6 +64,14 @@ struct Declaration {
     }
 };
 
+// A declaration together with the declarations nested inside of it (e.g the members of a class).
+struct OutlineNode {
+    Declaration declaration;
+    std::vector<OutlineNode> children;
+};
+
+using DocumentOutline = std::vector<OutlineNode>;
+
 #define FOR_EACH_SEMANTIC_TYPE        \
     __SEMANTIC(Unknown)               \
     __SEMANTIC(Regular)               \
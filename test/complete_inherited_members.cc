@@ -0,0 +1,35 @@
+struct Base {
+    int x_base;
+};
+
+struct Derived : public Base {
+    int x_derived;
+};
+
+void foo()
+{
+    Derived d;
+    d.x
+}
+
+struct Top {
+    int x_top;
+};
+
+struct Left : public Top {
+    int x_left;
+};
+
+struct Right : public Top {
+    int x_right;
+};
+
+struct Bottom : public Left, public Right {
+    int x_bottom;
+};
+
+void bar()
+{
+    Bottom b;
+    b.x
+}
\ No newline at end of file
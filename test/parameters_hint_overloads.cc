@@ -0,0 +1,7 @@
+void foo(int x, char y);
+void foo(int x);
+
+void bar()
+{
+    foo(1);
+}
\ No newline at end of file